@@ -0,0 +1,64 @@
+#include "Bench.h"
+
+#include <random>
+#include <vector>
+
+#include "ArenaGrid.h"
+
+using namespace std;
+
+//a 2048x2048 arena with a few hundred snakes wandering it: setting, clearing and testing cells, and what it costs
+//in memory against one flat bit per cell
+BENCH_SUITE(ArenaGrid)
+{
+	const int SIDE = 2048;
+	const int SNAKES = 400;
+	const int LENGTH = 64;
+	const int TICKS = 2000;
+
+	ArenaGrid arena;
+	arena.Resize(SIDE, SIDE);
+
+	//each snake a ring of cells it crawls around in, so cells get set and cleared at the same rate
+	mt19937 rng(99);
+	uniform_int_distribution<int> position(0, SIDE - 1);
+	vector<int> headX(SNAKES), headZ(SNAKES);
+	vector<int> body((size_t)SNAKES * LENGTH);
+	for (int s = 0; s < SNAKES; s++) {
+		headX[s] = position(rng);
+		headZ[s] = position(rng);
+		for (int i = 0; i < LENGTH; i++)
+			body[(size_t)s * LENGTH + i] = headZ[s] * SIDE + headX[s];
+		arena.Occupy(headX[s], headZ[s]);
+	}
+	for (int i = 0; i < SNAKES * 4; i++)
+		arena.AddEgg(position(rng), position(rng));
+
+	static const int stepX[4] = { 0, 1, 0, -1 };
+	static const int stepZ[4] = { -1, 0, 1, 0 };
+	unsigned long long hits = 0;
+	double start = benchNow();
+	for (int t = 0; t < TICKS; t++) {
+		for (int s = 0; s < SNAKES; s++) {
+			int d = (int)(rng() & 3);
+			int x = (headX[s] + stepX[d] + SIDE) % SIDE, z = (headZ[s] + stepZ[d] + SIDE) % SIDE;
+			hits += arena.Occupied(x, z);
+			if (arena.HasEgg(x, z)) {
+				arena.RemoveEgg(x, z);
+				arena.AddEgg(position(rng), position(rng));
+			}
+			int &tail = body[(size_t)s * LENGTH + t % LENGTH];
+			arena.Vacate(tail % SIDE, tail / SIDE);
+			arena.Occupy(x, z);
+			tail = z * SIDE + x;
+			headX[s] = x;
+			headZ[s] = z;
+		}
+	}
+	double elapsed = benchNow() - start;
+	benchKeep(hits);
+	benchReport("snake moves (test, egg check, vacate, occupy)", elapsed * 1e9 / ((double)TICKS * SNAKES), "ns/move");
+	benchReport("chunks in use", (double)arena.Occupancy().ChunksInUse(), "chunks");
+	benchReport("memory", arena.Bytes() / 1024.0, "KB");
+	benchReport("memory, two flat bitsets", 2.0 * SIDE * SIDE / 8 / 1024.0, "KB");
+}
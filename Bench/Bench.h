@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal benchmark harness. Each suite is a function registered with BENCH_SUITE(name) in its own .cpp,
+// the Bench executable runs all of them, or only the ones named on the command line.
+
+typedef void (*BenchFunction)();
+
+struct BenchSuite {
+	const char* name;
+	BenchFunction run;
+};
+
+std::vector<BenchSuite> &benchSuites();
+
+struct BenchRegistrar {
+	BenchRegistrar(const char* name, BenchFunction run)
+	{
+		BenchSuite suite = { name, run };
+		benchSuites().push_back(suite);
+	}
+};
+
+#define BENCH_SUITE(name) \
+	static void bench_##name(); \
+	static BenchRegistrar benchRegistrar_##name(#name, &bench_##name); \
+	static void bench_##name()
+
+// seconds on a monotonic clock
+inline double benchNow()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// prints one result line: "  label ......... value unit"
+inline void benchReport(const std::string &label, double value, const char* unit)
+{
+	std::cout << "  " << std::left << std::setw(48) << label << std::right << std::setw(14) << std::fixed << std::setprecision(2) << value << " " << unit << std::endl;
+}
+
+// stops the optimiser from throwing away work whose result is otherwise unused
+template<typename T>
+inline void benchKeep(const T &value)
+{
+	static volatile char sink;
+	sink = *reinterpret_cast<const volatile char*>(&value);
+	(void)sink;
+}
+
+// thread counts to run scaling tests at: 1, 2, 4, ... and finally every hardware thread
+inline std::vector<unsigned int> benchThreadCounts()
+{
+	unsigned int hardware = std::thread::hardware_concurrency();
+	if (hardware == 0)
+		hardware = 1;
+	std::vector<unsigned int> counts;
+	for (unsigned int threads = 1; threads < hardware; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(hardware);
+	return counts;
+}
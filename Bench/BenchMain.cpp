@@ -0,0 +1,39 @@
+#include "Bench.h"
+
+#include <cstring>
+
+using namespace std;
+
+vector<BenchSuite> &benchSuites()
+{
+	static vector<BenchSuite> suites;
+	return suites;
+}
+
+//runs every registered suite, or only the ones named on the command line
+int main(int argc, char** argv)
+{
+	vector<BenchSuite> &suites = benchSuites();
+	int ran = 0;
+	for (size_t i = 0; i < suites.size(); i++) {
+		bool selected = argc < 2;
+		for (int a = 1; a < argc && !selected; a++)
+			selected = strcmp(argv[a], suites[i].name) == 0;
+		if (!selected)
+			continue;
+
+		cout << suites[i].name << endl;
+		double start = benchNow();
+		suites[i].run();
+		cout << "  (" << fixed << setprecision(2) << benchNow() - start << "s)" << endl << endl;
+		ran++;
+	}
+
+	if (ran == 0) {
+		cout << "no suite matched, available suites:" << endl;
+		for (size_t i = 0; i < suites.size(); i++)
+			cout << "  " << suites[i].name << endl;
+		return 1;
+	}
+	return 0;
+}
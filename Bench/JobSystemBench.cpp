@@ -0,0 +1,95 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "JobSystem.h"
+
+using namespace std;
+
+static void emptyJob(Job*, const void*)
+{
+}
+
+//cost of creating, queueing, running and finishing a job that does nothing
+BENCH_SUITE(JobSpawn)
+{
+	const int JOBS = 1000; //stays well under the per-thread job pool
+	const int ROUNDS = 500;
+
+	vector<unsigned int> counts = benchThreadCounts();
+	for (size_t c = 0; c < counts.size(); c++) {
+		unsigned int threads = counts[c];
+		JobSystem jobs((int)threads - 1);
+		double start = benchNow();
+		for (int r = 0; r < ROUNDS; r++) {
+			Job* root = jobs.CreateJob(&emptyJob);
+			for (int i = 0; i < JOBS; i++)
+				jobs.Run(jobs.CreateJobAsChild(root, &emptyJob));
+			jobs.Run(root);
+			jobs.Wait(root);
+		}
+		double seconds = benchNow() - start;
+
+		stringstream label;
+		label << "spawn + run, " << threads << " thread(s)";
+		benchReport(label.str(), seconds * 1e9 / (JOBS * ROUNDS), "ns/job");
+	}
+}
+
+//ParallelFor over a compute bound loop, 1 thread up to every hardware thread
+BENCH_SUITE(ParallelForScaling)
+{
+	const unsigned int COUNT = 1 << 22;
+	const unsigned int GRAIN = 4096;
+	const int ROUNDS = 20;
+
+	vector<float> values(COUNT);
+	for (unsigned int i = 0; i < COUNT; i++)
+		values[i] = (float)i;
+
+	double baseline = 0.0;
+	vector<unsigned int> counts = benchThreadCounts();
+	for (size_t c = 0; c < counts.size(); c++) {
+		unsigned int threads = counts[c];
+		JobSystem jobs((int)threads - 1);
+		double start = benchNow();
+		for (int r = 0; r < ROUNDS; r++) {
+			jobs.ParallelFor(0, COUNT, GRAIN, [&values](unsigned int first, unsigned int last) {
+				for (unsigned int i = first; i < last; i++)
+					values[i] = std::sqrt(values[i] * values[i] + 1.0f);
+			});
+		}
+		double seconds = (benchNow() - start) / ROUNDS;
+		if (threads == 1)
+			baseline = seconds;
+
+		stringstream label;
+		label << threads << " thread(s)";
+		benchReport(label.str() + " time", seconds * 1000.0, "ms");
+		benchReport(label.str() + " speedup", baseline / seconds, "x");
+	}
+	benchKeep(values[COUNT / 2]);
+}
+
+//how the grain size trades scheduling overhead against load balance
+BENCH_SUITE(ParallelForGrain)
+{
+	const unsigned int COUNT = 1 << 22;
+	vector<float> values(COUNT, 1.0f);
+	JobSystem jobs;
+
+	for (unsigned int grain = 256; grain <= 65536; grain *= 4) {
+		double start = benchNow();
+		for (int r = 0; r < 10; r++) {
+			jobs.ParallelFor(0, COUNT, grain, [&values](unsigned int first, unsigned int last) {
+				for (unsigned int i = first; i < last; i++)
+					values[i] = values[i] * 0.5f + 0.5f;
+			});
+		}
+		stringstream label;
+		label << "grain " << grain << ", " << jobs.ThreadCount() << " thread(s)";
+		benchReport(label.str(), (benchNow() - start) * 100.0, "ms");
+	}
+	benchKeep(values[0]);
+}
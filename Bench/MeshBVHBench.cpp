@@ -0,0 +1,108 @@
+#include "Bench.h"
+
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "MeshBVH.h"
+
+using namespace std;
+
+//a bumpy sphere, about the triangle count of a detailed character model
+static void makeTestMesh(int rings, vector<glm::vec3> &positions, vector<unsigned int> &indices)
+{
+	mt19937 rng(99);
+	uniform_real_distribution<float> bump(0.95f, 1.05f);
+	int segments = rings * 2;
+	for (int i = 0; i <= rings; i++) {
+		float theta = 3.14159265f * i / rings;
+		for (int j = 0; j <= segments; j++) {
+			float phi = 6.2831853f * j / segments;
+			float r = bump(rng);
+			positions.push_back(glm::vec3(r * sin(theta) * cos(phi), r * cos(theta), r * sin(theta) * sin(phi)));
+		}
+	}
+	for (int i = 0; i < rings; i++) {
+		for (int j = 0; j < segments; j++) {
+			unsigned int a = i * (segments + 1) + j, b = a + 1, c = a + segments + 1, d = c + 1;
+			indices.push_back(a); indices.push_back(c); indices.push_back(b);
+			indices.push_back(b); indices.push_back(c); indices.push_back(d);
+		}
+	}
+}
+
+BENCH_SUITE(MeshBVH)
+{
+	const int RINGS = 200; //160k triangles
+	const int BUILD_ROUNDS = 5;
+	const unsigned int RAYS = 1 << 20;
+	const unsigned int GRAIN = 1024;
+
+	vector<glm::vec3> positions;
+	vector<unsigned int> indices;
+	makeTestMesh(RINGS, positions, indices);
+
+	MeshBVH bvh;
+	double start = benchNow();
+	for (int r = 0; r < BUILD_ROUNDS; r++)
+		bvh.Build(positions, indices);
+	double buildTime = (benchNow() - start) / BUILD_ROUNDS;
+	stringstream label;
+	label << "build, " << bvh.TriangleCount() << " triangles";
+	benchReport(label.str(), buildTime * 1000.0, "ms");
+
+	//rays from a shell around the mesh aimed somewhere near it, most of them hit
+	mt19937 rng(7);
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	vector<glm::vec3> origins(RAYS), directions(RAYS);
+	for (unsigned int i = 0; i < RAYS; i++) {
+		glm::vec3 from(unit(rng), unit(rng), unit(rng));
+		origins[i] = glm::normalize(from) * 3.0f;
+		glm::vec3 to(unit(rng) * 0.8f, unit(rng) * 0.8f, unit(rng) * 0.8f);
+		directions[i] = glm::normalize(to - origins[i]);
+	}
+
+	vector<unsigned int> counts = benchThreadCounts();
+	for (size_t c = 0; c < counts.size(); c++) {
+		unsigned int threads = counts[c];
+		JobSystem jobs((int)threads - 1);
+		atomic<unsigned int> hits(0);
+		start = benchNow();
+		jobs.ParallelFor(0, RAYS, GRAIN, [&](unsigned int first, unsigned int last) {
+			unsigned int found = 0;
+			for (unsigned int i = first; i < last; i++) {
+				RayHit hit;
+				if (bvh.Raycast(origins[i], directions[i], 10.0f, hit))
+					found++;
+			}
+			hits += found;
+		});
+		double seconds = benchNow() - start;
+		benchKeep(hits.load());
+
+		label.str("");
+		label << "raycast, " << threads << " thread(s)";
+		benchReport(label.str(), RAYS / seconds / 1e6, "Mrays/s");
+	}
+
+	//the head-vs-egg style overlap queries, single threaded
+	const unsigned int OVERLAPS = 1 << 18;
+	unsigned int overlapping = 0;
+	start = benchNow();
+	for (unsigned int i = 0; i < OVERLAPS; i++) {
+		if (bvh.OverlapsSphere(origins[i] * 0.35f, 0.1f))
+			overlapping++;
+	}
+	benchReport("sphere overlap", (benchNow() - start) * 1e9 / OVERLAPS, "ns/query");
+	start = benchNow();
+	for (unsigned int i = 0; i < OVERLAPS; i++) {
+		if (bvh.OverlapsCapsule(origins[i] * 0.35f, origins[i] * 0.3f + directions[i] * 0.2f, 0.05f))
+			overlapping++;
+	}
+	benchReport("capsule overlap", (benchNow() - start) * 1e9 / OVERLAPS, "ns/query");
+	benchKeep(overlapping);
+}
@@ -0,0 +1,50 @@
+#include "Bench.h"
+
+#include <sstream>
+
+#include "SnakeArena.h"
+
+using namespace std;
+
+//thousands of bots on a 2048x2048 arena, ticked on 1 up to 64 threads (past the hardware threads they only share
+//cores). every run starts the same and has to end the same as the single threaded one
+BENCH_SUITE(SnakeArenaScaling)
+{
+	const int SIDE = 2048;
+	const int SNAKES = 8192;
+	const int WARMUP_TICKS = 50; //so bodies have grown and rings moved around the pool before timing
+	const int TICKS = 200;
+	const unsigned int MAX_THREADS = 64;
+
+	double baseline = 0.0;
+	uint64_t serialChecksum = 0;
+	for (unsigned int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		SnakeArena arena(SIDE, SIDE, 2024, (int)threads);
+		arena.SetGrowthPerEgg(2);
+		arena.SetEggTarget(SNAKES);
+		for (int s = 0; s < SNAKES; s++)
+			arena.SpawnAnywhere(SNAKE_CONTROL_BOT);
+		for (int t = 0; t < WARMUP_TICKS; t++)
+			arena.Tick();
+
+		double start = benchNow();
+		for (int t = 0; t < TICKS; t++)
+			arena.Tick();
+		double seconds = (benchNow() - start) / TICKS;
+		uint64_t checksum = arena.Checksum();
+		if (threads == 1) {
+			baseline = seconds;
+			serialChecksum = checksum;
+		}
+
+		stringstream label;
+		label << threads << " thread(s)";
+		benchReport(label.str() + " tick", seconds * 1000.0, "ms");
+		benchReport(label.str() + " speedup", baseline / seconds, "x");
+		benchReport(label.str() + " same as serial", checksum == serialChecksum ? 1.0 : 0.0, "");
+		if (threads == 1) {
+			benchReport("snakes alive", (double)arena.AliveCount(), "");
+			benchReport("segment pool", arena.SegmentPoolSize() * sizeof(int) / 1024.0, "KB");
+		}
+	}
+}
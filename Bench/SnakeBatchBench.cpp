@@ -0,0 +1,40 @@
+#include "Bench.h"
+
+#include <random>
+
+#include "SnakeBatch.h"
+
+using namespace std;
+
+//env steps a second for a batch of games on every hardware thread, random actions, observations included
+BENCH_SUITE(SnakeBatch)
+{
+	const int SIZE = 16;
+	const unsigned int BATCH_SIZES[] = { 1024, 16384 };
+	const unsigned long long ENV_STEPS = 20000000; //per batch size, so both take about as long
+	const int ACTION_SETS = 64; //precomputed so the benchmark isn't timing the random number generator
+
+	for (unsigned int games : BATCH_SIZES) {
+		SnakeBatch batch(games, SIZE, SIZE, 1);
+		vector<uint64_t> observations(games * batch.ObservationWords());
+		vector<float> rewards(games);
+		vector<unsigned char> dones(games);
+
+		mt19937 rng(1234);
+		vector<int> actions((size_t)games * ACTION_SETS);
+		for (size_t i = 0; i < actions.size(); i++)
+			actions[i] = (int)(rng() & 3);
+
+		batch.Reset(&observations[0]);
+		unsigned long long steps = ENV_STEPS / games;
+		unsigned long long episodes = 0;
+		double start = benchNow();
+		for (unsigned long long s = 0; s < steps; s++) {
+			batch.Step(&actions[(s % ACTION_SETS) * games], &observations[0], &rewards[0], &dones[0]);
+			episodes += dones[s % games];
+		}
+		double elapsed = benchNow() - start;
+		benchKeep(episodes);
+		benchReport("N = " + to_string(games) + ", " + to_string(batch.ObservationWords() * 8) + " byte observations", steps * games / elapsed / 1e6, "M env steps/s");
+	}
+}
@@ -0,0 +1,86 @@
+#include "Bench.h"
+
+#include <vector>
+
+#include "SnakeBot.h"
+#include "SnakeReplay.h"
+
+using namespace std;
+
+//a cycle bot filling a 48x48 grid, getting on for a million ticks: what recording costs, how big the replay comes out
+//and how fast it plays back and seeks
+BENCH_SUITE(SnakeReplay)
+{
+	const int SIDE = 48;
+	const uint64_t SEED = 2024;
+	const int SEEKS = 64;
+
+	SnakeSim sim(SIDE, SIDE);
+	SnakeCycleBot bot(SIDE, SIDE);
+	sim.Reset(SIDE / 2, SIDE / 2, SNAKE_UP, 4, SEED);
+	double start = benchNow();
+	while (sim.Alive()) {
+		sim.Turn(bot.Move(sim));
+		sim.Tick();
+	}
+	double playSeconds = benchNow() - start;
+	unsigned long long ticks = sim.Ticks();
+
+	SnakeReplayRecorder recorder;
+	sim.Reset(SIDE / 2, SIDE / 2, SNAKE_UP, 4, SEED);
+	start = benchNow();
+	recorder.Begin(sim, SEED);
+	while (sim.Alive()) {
+		sim.Turn(bot.Move(sim));
+		recorder.Record(sim);
+		sim.Tick();
+	}
+	double recordSeconds = benchNow() - start;
+	int finalScore = sim.Score();
+
+	vector<unsigned char> data, inputOnly;
+	start = benchNow();
+	recorder.Write(data);
+	double writeSeconds = benchNow() - start;
+	SnakeReplayRecorder noKeyframes;
+	sim.Reset(SIDE / 2, SIDE / 2, SNAKE_UP, 4, SEED);
+	noKeyframes.Begin(sim, SEED, ~0u);
+	while (sim.Alive()) {
+		sim.Turn(bot.Move(sim));
+		noKeyframes.Record(sim);
+		sim.Tick();
+	}
+	noKeyframes.Write(inputOnly);
+
+	SnakeReplay replay;
+	start = benchNow();
+	replay.Load(&data[0], data.size());
+	double loadSeconds = benchNow() - start;
+
+	start = benchNow();
+	replay.Seek(sim, 0);
+	replay.Play(sim, 0, replay.Ticks());
+	double fastForwardSeconds = benchNow() - start;
+	bool sameScore = sim.Score() == finalScore;
+
+	//seeks spread over the whole game, each one lands on a keyframe then plays up to the tick
+	uint64_t landed = 0;
+	start = benchNow();
+	for (int s = 0; s < SEEKS; s++) {
+		replay.Seek(sim, ticks * s / SEEKS + s);
+		landed += sim.Ticks();
+	}
+	double seekSeconds = (benchNow() - start) / SEEKS;
+	benchKeep(landed);
+
+	benchReport("game ticks", (double)ticks, "");
+	benchReport("replay", data.size() / 1024.0, "KB");
+	benchReport("replay without keyframes", inputOnly.size() / 1024.0, "KB");
+	benchReport("keyframes", (double)replay.Keyframes(), "");
+	benchReport("record overhead", (recordSeconds - playSeconds) / playSeconds * 100.0, "%");
+	benchReport("write", writeSeconds * 1000.0, "ms");
+	benchReport("load", loadSeconds * 1000.0, "ms");
+	benchReport("fast-forward", ticks / fastForwardSeconds / 1e6, "M ticks/s");
+	benchReport("fast-forward same score", sameScore ? 1.0 : 0.0, "");
+	benchReport("seek", seekSeconds * 1000.0, "ms");
+}
@@ -0,0 +1,128 @@
+#include "Bench.h"
+
+#include <string>
+
+#include "SnakeBot.h"
+#include "SnakeSim.h"
+
+using namespace std;
+
+//raw tick rate of the rules on their own, then with a bot making a decision every tick
+BENCH_SUITE(SnakeSim)
+{
+	const int SIZE = 32;
+	const unsigned long long TICKS = 20000000;
+
+	SnakeSim sim(SIZE, SIZE);
+
+	//up and down the columns until it runs off the far side, barely any decision so this is mostly the rules
+	unsigned long long games = 0;
+	sim.Reset(0, SIZE - 4, SNAKE_UP, 4, 1);
+	double start = benchNow();
+	for (unsigned long long t = 0; t < TICKS; t++) {
+		if (sim.HeadZ() == 0 && sim.Direction() == SNAKE_UP)
+			sim.Turn(SNAKE_RIGHT);
+		else if (sim.HeadZ() == SIZE - 1 && sim.Direction() == SNAKE_DOWN)
+			sim.Turn(SNAKE_RIGHT);
+		else if (sim.Direction() == SNAKE_RIGHT)
+			sim.Turn(sim.HeadZ() == 0 ? SNAKE_DOWN : SNAKE_UP);
+		if (sim.Tick() >= SNAKE_HIT_WALL) {
+			games++;
+			sim.Reset(0, SIZE - 4, SNAKE_UP, 4, t + 2);
+		}
+	}
+	double elapsed = benchNow() - start;
+	benchKeep(games);
+	benchReport("ticks, sweeping", TICKS / elapsed / 1e6, "M ticks/s");
+
+	unsigned long long eggs = 0;
+	games = 0;
+	sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, 1);
+	start = benchNow();
+	for (unsigned long long t = 0; t < TICKS; t++) {
+		sim.Turn(GreedyMove(sim));
+		if (sim.Tick() >= SNAKE_HIT_WALL) {
+			games++;
+			eggs += sim.Score();
+			sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, t + 2);
+		}
+	}
+	elapsed = benchNow() - start;
+	benchReport("ticks, greedy bot", TICKS / elapsed / 1e6, "M ticks/s");
+	benchReport("games, greedy bot", games / elapsed, "games/s");
+	benchReport("eggs per game, greedy bot", games ? (double)eggs / games : 0.0, "eggs");
+
+	//the autopilot runs a search or two every tick and plays games of a hundred thousand ticks or more, so fewer ticks
+	const unsigned long long AUTOPILOT_TICKS = TICKS / 100;
+	const int STARVE_TICKS = SIZE * SIZE * 4;
+	SnakeAutopilot autopilot(SIZE, SIZE);
+	eggs = 0;
+	games = 0;
+	int sinceEgg = 0;
+	sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, 1);
+	start = benchNow();
+	for (unsigned long long t = 0; t < AUTOPILOT_TICKS; t++) {
+		sim.Turn(autopilot.Move(sim));
+		SnakeTickResult result = sim.Tick();
+		sinceEgg = result == SNAKE_ATE ? 0 : sinceEgg + 1;
+		if (result >= SNAKE_HIT_WALL || sinceEgg >= STARVE_TICKS) {
+			games++;
+			eggs += sim.Score();
+			sinceEgg = 0;
+			sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, t + 2);
+		}
+	}
+	elapsed = benchNow() - start;
+	benchReport("ticks, autopilot", AUTOPILOT_TICKS / elapsed / 1e6, "M ticks/s");
+	benchReport("eggs per game, autopilot", games ? (double)eggs / games : 0.0, "eggs");
+
+	//the cycle bot fills the grid every game, so this is mostly ticks with the snake at or near full length
+	SnakeCycleBot cycleBot(SIZE, SIZE);
+	unsigned long long filled = 0;
+	games = 0;
+	sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, 1);
+	start = benchNow();
+	for (unsigned long long t = 0; t < TICKS; t++) {
+		sim.Turn(cycleBot.Move(sim));
+		SnakeTickResult result = sim.Tick();
+		if (result >= SNAKE_HIT_WALL) {
+			games++;
+			filled += result == SNAKE_FILLED;
+			sim.Reset(SIZE / 2, SIZE / 2, SNAKE_UP, 4, t + 2);
+		}
+	}
+	elapsed = benchNow() - start;
+	benchKeep(filled);
+	benchReport("ticks, cycle bot", TICKS / elapsed / 1e6, "M ticks/s");
+	benchReport("games filled, cycle bot", games ? 100.0 * filled / games : 0.0, "%");
+
+	//grids with an odd number of cells have no Hamiltonian cycle, how the cycle bot's games end there. A game is
+	//called off as starved once the bot has circled a few times past an egg it won't eat
+	const int ODD_SIDES[] = { 9, 31 };
+	const int ODD_GAMES[] = { 400, 40 };
+	for (int s = 0; s < 2; s++) {
+		int side = ODD_SIDES[s];
+		SnakeSim oddSim(side, side);
+		SnakeCycleBot oddBot(side, side);
+		int ended[SNAKE_DEAD + 1] = {};
+		int starved = 0;
+		for (int game = 0; game < ODD_GAMES[s]; game++) {
+			oddSim.Reset(side / 2, side / 2, SNAKE_UP, 4, game + 1);
+			int sinceEgg = 0;
+			while (oddSim.Alive() && sinceEgg < side * side * 4) {
+				oddSim.Turn(oddBot.Move(oddSim));
+				SnakeTickResult result = oddSim.Tick();
+				sinceEgg = result == SNAKE_ATE ? 0 : sinceEgg + 1;
+				if (result >= SNAKE_HIT_WALL)
+					ended[result]++;
+			}
+			starved += oddSim.Alive();
+		}
+		string label = to_string(side) + "x" + to_string(side) + " cycle bot, ";
+		double perGame = 100.0 / ODD_GAMES[s];
+		benchReport(label + "filled", ended[SNAKE_FILLED] * perGame, "%");
+		benchReport(label + "starved", starved * perGame, "%");
+		benchReport(label + "hit wall", ended[SNAKE_HIT_WALL] * perGame, "%");
+		benchReport(label + "hit self", ended[SNAKE_HIT_SELF] * perGame, "%");
+	}
+}
@@ -0,0 +1,90 @@
+#include "Bench.h"
+
+#include <sstream>
+#include <vector>
+
+#include "SnakeBot.h"
+#include "SnakeSnapshot.h"
+
+using namespace std;
+
+//saving and loading a game a third and two thirds of the way to filling the grid (the free cells are listed from
+//half full), then a whole game on a 32x32 grid with a snapshot pushed for rewinding every tick
+BENCH_SUITE(SnakeSnapshot)
+{
+	const int SIDES[] = { 32, 256 };
+	const int REPEATS = 2000;
+
+	for (int side : SIDES) {
+		SnakeSim sim(side, side);
+		SnakeSim loaded(side, side);
+		SnakeCycleBot bot(side, side);
+		vector<uint64_t> blob((SnakeSim::MaxSnapshotSize(side, side) + 7) / 8);
+		unsigned char* data = (unsigned char*)&blob[0];
+		sim.Reset(side / 2, side / 2, SNAKE_UP, 4, 2024);
+		sim.SetGrowthPerEgg(side / 8);
+		for (int third = 1; third <= 2; third++) {
+			while (sim.Alive() && sim.Length() < side * side * third / 3) {
+				sim.Turn(bot.Move(sim));
+				sim.Tick();
+			}
+			double start = benchNow();
+			for (int r = 0; r < REPEATS; r++)
+				sim.SaveSnapshot(data);
+			double saveSeconds = (benchNow() - start) / REPEATS;
+			uint64_t loadedTicks = 0;
+			start = benchNow();
+			for (int r = 0; r < REPEATS; r++) {
+				loaded.LoadSnapshot(data, sim.SnapshotSize());
+				loadedTicks += loaded.Ticks();
+			}
+			double loadSeconds = (benchNow() - start) / REPEATS;
+			benchKeep(loadedTicks);
+			vector<unsigned char> saved, restored;
+			sim.WriteState(saved);
+			loaded.WriteState(restored);
+
+			stringstream label;
+			label << side << "x" << side << " " << third << "/3 full";
+			benchReport(label.str() + " snapshot", sim.SnapshotSize() / 1024.0, "KB");
+			benchReport(label.str() + " save", saveSeconds * 1e6, "us");
+			benchReport(label.str() + " load", loadSeconds * 1e6, "us");
+			benchReport(label.str() + " round trip ok", saved == restored ? 1.0 : 0.0, "");
+		}
+	}
+
+	const int SIDE = 32;
+	const unsigned int REWIND_TICKS = 600; //ten seconds at 60 ticks a second
+	SnakeSim sim(SIDE, SIDE);
+	SnakeCycleBot bot(SIDE, SIDE);
+	SnakeRewind rewind(SIDE, SIDE, REWIND_TICKS);
+	for (int pushing = 0; pushing < 2; pushing++) {
+		sim.Reset(SIDE / 2, SIDE / 2, SNAKE_UP, 4, 2024);
+		double start = benchNow();
+		while (sim.Alive()) {
+			sim.Turn(bot.Move(sim));
+			sim.Tick();
+			if (pushing)
+				rewind.Push(sim);
+		}
+		double seconds = (benchNow() - start) / sim.Ticks();
+		benchReport(pushing ? "32x32 game, push every tick" : "32x32 game", seconds * 1e9, "ns/tick");
+	}
+	benchReport("rewind buffer", rewind.Capacity() * SnakeSim::MaxSnapshotSize(SIDE, SIDE) / 1024.0, "KB");
+	double start = benchNow();
+	bool rewound = rewind.Rewind(sim, REWIND_TICKS - 1);
+	benchReport("rewind 599 ticks", (benchNow() - start) * 1e6, "us");
+
+	//the same game played again up to the tick it rewound to has to come out the same
+	SnakeSim replayed(SIDE, SIDE);
+	SnakeCycleBot replayBot(SIDE, SIDE);
+	replayed.Reset(SIDE / 2, SIDE / 2, SNAKE_UP, 4, 2024);
+	while (replayed.Alive() && replayed.Ticks() < sim.Ticks()) {
+		replayed.Turn(replayBot.Move(replayed));
+		replayed.Tick();
+	}
+	vector<unsigned char> rewoundState, replayedState;
+	sim.WriteState(rewoundState);
+	replayed.WriteState(replayedState);
+	benchReport("rewind round trip ok", rewound && rewoundState == replayedState ? 1.0 : 0.0, "");
+}
@@ -0,0 +1,80 @@
+#include "Bench.h"
+
+#include <random>
+#include <sstream>
+
+#include "SpatialGrid.h"
+
+using namespace std;
+
+//100k segment sized entities wandering a big arena: insert, move, neighbour queries, against a brute force scan
+BENCH_SUITE(SpatialGrid)
+{
+	const int ENTITIES = 100000;
+	const float SEGMENT_RADIUS = 2.5f;
+	const float ARENA_SIZE = 1600.0f; //roughly what 100k segments need to have room to move
+	const int MOVE_ROUNDS = 20;
+	const int BRUTE_QUERIES = 200; //brute force is O(n) a query, only time a few
+
+	mt19937 rng(1234);
+	uniform_real_distribution<float> position(0.0f, ARENA_SIZE);
+	uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+	vector<float> x(ENTITIES), z(ENTITIES);
+	for (int i = 0; i < ENTITIES; i++) {
+		x[i] = position(rng);
+		z[i] = position(rng);
+	}
+
+	SpatialGrid grid(0.0f, 0.0f, ARENA_SIZE, ARENA_SIZE, SEGMENT_RADIUS * 2.0f);
+	vector<int> ids(ENTITIES);
+	double start = benchNow();
+	for (int i = 0; i < ENTITIES; i++)
+		ids[i] = grid.Insert(x[i], z[i], i);
+	benchReport("insert", (benchNow() - start) * 1e9 / ENTITIES, "ns/entity");
+
+	start = benchNow();
+	for (int r = 0; r < MOVE_ROUNDS; r++) {
+		for (int i = 0; i < ENTITIES; i++) {
+			x[i] += step(rng);
+			z[i] += step(rng);
+			grid.Move(ids[i], x[i], z[i]);
+		}
+	}
+	benchReport("move", (benchNow() - start) * 1e9 / ((double)ENTITIES * MOVE_ROUNDS), "ns/entity");
+
+	//everything touching each entity, the self collision check
+	unsigned long long found = 0;
+	start = benchNow();
+	for (int i = 0; i < ENTITIES; i++)
+		grid.ForEachNear(x[i], z[i], SEGMENT_RADIUS * 2.0f, [&found](int) { found++; });
+	double gridQuery = (benchNow() - start) / ENTITIES;
+	benchKeep(found);
+	benchReport("query, grid", gridQuery * 1e9, "ns/query");
+
+	unsigned long long bruteFound = 0;
+	float touching = SEGMENT_RADIUS * 2.0f;
+	start = benchNow();
+	for (int q = 0; q < BRUTE_QUERIES; q++) {
+		for (int i = 0; i < ENTITIES; i++) {
+			float dx = x[i] - x[q], dz = z[i] - z[q];
+			if (dx * dx + dz * dz <= touching * touching)
+				bruteFound++;
+		}
+	}
+	double bruteQuery = (benchNow() - start) / BRUTE_QUERIES;
+	benchKeep(bruteFound);
+	benchReport("query, brute force", bruteQuery * 1e9, "ns/query");
+	benchReport("grid speedup", bruteQuery / gridQuery, "x");
+
+	//the grid has to find exactly what the brute force did for the same entities
+	unsigned long long gridFound = 0;
+	for (int q = 0; q < BRUTE_QUERIES; q++)
+		grid.ForEachNear(x[q], z[q], touching, [&gridFound](int) { gridFound++; });
+	benchReport("grid matches brute force", gridFound == bruteFound ? 1.0 : 0.0, "");
+
+	start = benchNow();
+	for (int i = 0; i < ENTITIES; i++)
+		grid.Remove(ids[i]);
+	benchReport("remove", (benchNow() - start) * 1e9 / ENTITIES, "ns/entity");
+}
@@ -0,0 +1,135 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <sstream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "JobSystem.h"
+#include "TransformStore.h"
+
+using namespace std;
+
+//world matrices for 1k/10k/100k entities that all moved this frame:
+//the usual per-object glm translate/rotate/scale chain against the batched SoA store
+BENCH_SUITE(TransformCompose)
+{
+	const unsigned int COUNTS[] = { 1000, 10000, 100000 };
+	const unsigned int TOTAL = 2000000; //entity updates per measurement, so small counts still run long enough
+
+	JobSystem jobs;
+
+	for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++) {
+		unsigned int count = COUNTS[c];
+		int rounds = TOTAL / count;
+
+		vector<glm::vec3> positions(count), scales(count);
+		vector<float> angles(count);
+		TransformStore store;
+		store.Reserve(count);
+		for (unsigned int i = 0; i < count; i++) {
+			positions[i] = glm::vec3((float)(i % 80) - 40.0f, 0.0f, -(float)(i % 65));
+			scales[i] = glm::vec3(1.0f + (i % 7) * 0.25f);
+			angles[i] = i * 0.01f;
+			store.Create(positions[i], glm::angleAxis(angles[i], glm::vec3(0, 1, 0)), scales[i]);
+		}
+
+		//per object glm, the way the game used to build its model matrices
+		vector<glm::mat4> world(count);
+		double start = benchNow();
+		for (int r = 0; r < rounds; r++) {
+			for (unsigned int i = 0; i < count; i++) {
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, positions[i]);
+				model = glm::rotate(model, angles[i], glm::vec3(0, 1, 0));
+				model = glm::scale(model, scales[i]);
+				world[i] = model;
+			}
+			benchKeep(world[r % count]);
+		}
+		double glmTime = benchNow() - start;
+
+		//batched, every entity dirty each round
+		start = benchNow();
+		for (int r = 0; r < rounds; r++) {
+			for (unsigned int i = 0; i < count; i++)
+				store.SetPosition(i, positions[i]);
+			store.Update();
+			benchKeep(store.World(r % count));
+		}
+		double storeTime = benchNow() - start;
+
+		//batched and split over every hardware thread
+		start = benchNow();
+		for (int r = 0; r < rounds; r++) {
+			for (unsigned int i = 0; i < count; i++)
+				store.SetPosition(i, positions[i]);
+			store.Update(&jobs);
+			benchKeep(store.World(r % count));
+		}
+		double parallelTime = benchNow() - start;
+
+		double updates = (double)rounds * count;
+		stringstream label;
+		label << count << " entities, glm per object";
+		benchReport(label.str(), glmTime * 1e9 / updates, "ns/entity");
+		label.str("");
+		label << count << " entities, SoA batched";
+		benchReport(label.str(), storeTime * 1e9 / updates, "ns/entity");
+		label.str("");
+		label << count << " entities, SoA batched, " << jobs.ThreadCount() << " thread(s)";
+		benchReport(label.str(), parallelTime * 1e9 / updates, "ns/entity");
+	}
+}
+
+//a parented mix where only some entities move each round, checked every round against a second store that
+//recomposes everything. a clean entity sharing a group of four with a moved one has to keep its parent's transform
+BENCH_SUITE(TransformParented)
+{
+	const unsigned int COUNT = 10000;
+	const unsigned int ROOTS = 100;
+	const int ROUNDS = 200;
+
+	JobSystem jobs;
+	TransformStore partial, full;
+	for (unsigned int i = 0; i < COUNT; i++) {
+		int parent = i < ROOTS ? TransformStore::NO_PARENT : (int)(((i * 2654435761u) >> 8) % i);
+		glm::vec3 position((float)(i % 50), (float)(i % 3), -(float)(i % 41));
+		glm::quat rotation = glm::angleAxis(i * 0.1f, glm::vec3(0, 1, 0));
+		glm::vec3 scale(1.0f + (i % 5) * 0.1f);
+		partial.Create(position, rotation, scale, parent);
+		full.Create(position, rotation, scale, parent);
+	}
+
+	float worstError = 0.0f;
+	unsigned int seed = 1;
+	double seconds = 0.0;
+	for (int r = 0; r < ROUNDS; r++) {
+		//about one in twenty moves, roots included
+		for (unsigned int i = 0; i < COUNT; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			if ((seed >> 16) % 20 == 0)
+				partial.SetPosition(i, partial.GetPosition(i) + glm::vec3(0.5f, 0.0f, -0.25f));
+		}
+		double start = benchNow();
+		partial.Update(r & 1 ? &jobs : NULL);
+		seconds += benchNow() - start;
+
+		for (unsigned int i = 0; i < COUNT; i++)
+			full.SetPosition(i, partial.GetPosition(i));
+		full.Update();
+		for (unsigned int i = 0; i < COUNT; i++) {
+			const glm::mat4 &a = partial.World(i), &b = full.World(i);
+			for (int c = 0; c < 4; c++) {
+				for (int row = 0; row < 4; row++)
+					worstError = max(worstError, fabs(a[c][row] - b[c][row]));
+			}
+		}
+	}
+
+	benchReport("10000 entities, 1/20 moving, update", seconds / ROUNDS * 1e6, "us");
+	benchReport("largest difference to a full update", worstError, "");
+	benchReport("matches full update", worstError < 1e-3f ? 1.0 : 0.0, "");
+}
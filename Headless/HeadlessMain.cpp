@@ -0,0 +1,368 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "JobSystem.h"
+#include "SnakeBot.h"
+#include "SnakeReplay.h"
+#include "SnakeSim.h"
+
+using namespace std;
+
+// Plays lots of games of the simulation core with a bot on every core, no window, GL or assets involved.
+// Every game gets its own seed (SnakeSeed) derived from the run's seed and its index, so a run gives the same results
+// however many threads it is spread over. That also means any one game can be played again on its own, which is
+// how --record saves it as a replay, and --replay plays a saved one back as fast as the simulation goes.
+
+enum HeadlessBot {
+	BOT_GREEDY,	// GreedyMove
+	BOT_ASTAR,	// SnakeAutopilot
+	BOT_CYCLE,	// SnakeCycleBot
+	BOT_COUNT
+};
+
+static const char* BOT_NAMES[BOT_COUNT] = { "greedy", "astar", "cycle" };
+
+// one of each bot per worker, they keep buffers sized for the grid
+struct HeadlessBots {
+	SnakeAutopilot autopilot;
+	SnakeCycleBot cycle;
+
+	HeadlessBots(int width, int height) : autopilot(width, height), cycle(width, height) {}
+
+	SnakeDirection Move(HeadlessBot bot, const SnakeSim &sim)
+	{
+		switch (bot) {
+		case BOT_ASTAR: return autopilot.Move(sim);
+		case BOT_CYCLE: return cycle.Move(sim);
+		default: return GreedyMove(sim);
+		}
+	}
+};
+
+struct HeadlessOptions {
+	unsigned int games;
+	int threads; // -1 is every hardware thread
+	uint64_t seed;
+	int width, height;
+	int length;
+	int growth;
+	int starveTicks; // a game ends after this many ticks without an egg, 0 is width * height * 4
+	HeadlessBot bot;
+	const char* recordPath; // game recordGame of the run saved here as a replay
+	unsigned int recordGame;
+	const char* replayPath; // play this replay instead of running games, from tick seekTick on
+	unsigned long long seekTick;
+
+	HeadlessOptions() : games(100000), threads(-1), seed(1), width(32), height(32), length(4), growth(1), starveTicks(0), bot(BOT_GREEDY),
+		recordPath(NULL), recordGame(0), replayPath(NULL), seekTick(0) {}
+};
+
+enum GameEnd {
+	END_WALL,
+	END_SELF,
+	END_FILLED,
+	END_STARVED,
+	END_COUNT
+};
+
+static const char* GAME_END_NAMES[END_COUNT] = { "hit wall", "hit self", "filled grid", "starved" };
+
+struct HeadlessStats {
+	unsigned long long games;
+	unsigned long long ticks;
+	unsigned long long ends[END_COUNT];
+	vector<unsigned long long> scores; // games that ended on each score
+
+	explicit HeadlessStats(int maxScore) : games(0), ticks(0), scores(maxScore + 1, 0)
+	{
+		for (int i = 0; i < END_COUNT; i++)
+			ends[i] = 0;
+	}
+
+	void Add(const HeadlessStats &other)
+	{
+		games += other.games;
+		ticks += other.ticks;
+		for (int i = 0; i < END_COUNT; i++)
+			ends[i] += other.ends[i];
+		for (size_t i = 0; i < scores.size(); i++)
+			scores[i] += other.scores[i];
+	}
+};
+
+//recorder, when there is one, gets every tick of the game
+static void playGame(SnakeSim &sim, HeadlessBots &bots, const HeadlessOptions &options, unsigned int game, HeadlessStats &stats,
+	SnakeReplayRecorder* recorder = NULL)
+{
+	uint64_t seed = SnakeSeed(options.seed, game);
+	sim.Reset(options.width / 2, options.height / 2, SNAKE_UP, options.length, seed);
+	sim.SetGrowthPerEgg(options.growth);
+	if (recorder)
+		recorder->Begin(sim, seed);
+	int starveTicks = options.starveTicks > 0 ? options.starveTicks : options.width * options.height * 4;
+
+	GameEnd end = END_STARVED;
+	int sinceEgg = 0;
+	while (sinceEgg < starveTicks) {
+		sim.Turn(bots.Move(options.bot, sim));
+		if (recorder)
+			recorder->Record(sim);
+		SnakeTickResult result = sim.Tick();
+		if (result == SNAKE_MOVED) {
+			sinceEgg++;
+			continue;
+		}
+		if (result == SNAKE_ATE) {
+			sinceEgg = 0;
+			continue;
+		}
+		end = result == SNAKE_HIT_WALL ? END_WALL : result == SNAKE_HIT_SELF ? END_SELF : END_FILLED;
+		break;
+	}
+
+	stats.games++;
+	stats.ticks += sim.Ticks();
+	stats.ends[end]++;
+	stats.scores[sim.Score()]++;
+}
+
+//smallest score at least fraction of the games reached
+static int percentile(const HeadlessStats &stats, double fraction)
+{
+	unsigned long long target = (unsigned long long)(fraction * stats.games);
+	unsigned long long seen = 0;
+	for (size_t i = 0; i < stats.scores.size(); i++) {
+		seen += stats.scores[i];
+		if (seen > target)
+			return (int)i;
+	}
+	return (int)stats.scores.size() - 1;
+}
+
+static void printStats(const HeadlessStats &stats, const HeadlessOptions &options, unsigned int threads, double seconds)
+{
+	cout << fixed << setprecision(2);
+	cout << "games          " << stats.games << " on a " << options.width << "x" << options.height << " grid, " << threads << " threads, seed " << options.seed
+		<< ", " << BOT_NAMES[options.bot] << " bot" << endl;
+	cout << "time           " << seconds << " s" << endl;
+	cout << "games/s        " << stats.games / seconds << endl;
+	cout << "ticks/s        " << stats.ticks / seconds / 1e6 << " M (" << (double)stats.ticks / stats.games << " ticks per game)" << endl;
+
+	if (stats.games == 0)
+		return;
+	double total = 0.0;
+	int minScore = -1, maxScore = 0;
+	for (size_t i = 0; i < stats.scores.size(); i++) {
+		if (!stats.scores[i])
+			continue;
+		total += (double)i * stats.scores[i];
+		if (minScore < 0)
+			minScore = (int)i;
+		maxScore = (int)i;
+	}
+	cout << "score          mean " << total / stats.games << ", min " << minScore << ", p10 " << percentile(stats, 0.1) << ", p50 " << percentile(stats, 0.5)
+		<< ", p90 " << percentile(stats, 0.9) << ", p99 " << percentile(stats, 0.99) << ", max " << maxScore << endl;
+
+	cout << "ended by       ";
+	for (int i = 0; i < END_COUNT; i++)
+		cout << (i ? ", " : "") << GAME_END_NAMES[i] << " " << 100.0 * stats.ends[i] / stats.games << "%";
+	cout << endl;
+
+	//ten buckets between the lowest and highest score
+	const int BUCKETS = 10;
+	const int BAR_WIDTH = 50;
+	int bucketSize = (maxScore - minScore) / BUCKETS + 1;
+	unsigned long long counts[BUCKETS] = {};
+	unsigned long long largest = 0;
+	for (int i = minScore; i <= maxScore; i++) {
+		unsigned long long &count = counts[(i - minScore) / bucketSize];
+		count += stats.scores[i];
+		largest = count > largest ? count : largest;
+	}
+	cout << "scores" << endl;
+	for (int b = 0; b < BUCKETS && minScore + b * bucketSize <= maxScore; b++) {
+		int first = minScore + b * bucketSize;
+		cout << "  " << setw(5) << first << "-" << left << setw(5) << first + bucketSize - 1 << right << setw(10) << counts[b] << " "
+			<< string((size_t)(counts[b] * BAR_WIDTH / largest), '#') << endl;
+	}
+}
+
+static void printUsage()
+{
+	cout << "usage: Headless [--games N] [--threads N] [--seed N] [--width N] [--height N] [--length N] [--growth N] [--starve N] [--bot greedy|astar|cycle]" << endl;
+	cout << "                [--record FILE [--record-game N]]" << endl;
+	cout << "       Headless --replay FILE [--seek N]" << endl;
+	cout << "  --threads 0 runs on this thread only, leave it out for every hardware thread" << endl;
+	cout << "  --starve is ticks without an egg before a game is called off, default width * height * 4" << endl;
+	cout << "  --bot astar plans a safe path to every egg, cycle follows a cycle through every cell and fills the grid when" << endl;
+	cout << "        width * height is even (on odd grids it stops a row and a column short and circles until starved)," << endl;
+	cout << "        greedy (the default) just heads for the egg" << endl;
+	cout << "  --record saves game N of the run (default 0) as a replay, --replay plays one back headless from tick N" << endl;
+}
+
+static bool parseOptions(int argc, char** argv, HeadlessOptions &options)
+{
+	for (int a = 1; a < argc; a++) {
+		if (a + 1 >= argc) {
+			cout << "ERROR::HEADLESS::MISSING_VALUE " << argv[a] << endl;
+			return false;
+		}
+		const char* name = argv[a];
+		if (strcmp(name, "--bot") == 0) {
+			const char* bot = argv[++a];
+			int b = 0;
+			while (b < BOT_COUNT && strcmp(bot, BOT_NAMES[b]) != 0)
+				b++;
+			if (b == BOT_COUNT) {
+				cout << "ERROR::HEADLESS::UNKNOWN_BOT " << bot << endl;
+				return false;
+			}
+			options.bot = (HeadlessBot)b;
+			continue;
+		}
+		if (strcmp(name, "--record") == 0) {
+			options.recordPath = argv[++a];
+			continue;
+		}
+		if (strcmp(name, "--replay") == 0) {
+			options.replayPath = argv[++a];
+			continue;
+		}
+		unsigned long long value = strtoull(argv[++a], NULL, 10);
+		if (strcmp(name, "--games") == 0)
+			options.games = (unsigned int)value;
+		else if (strcmp(name, "--threads") == 0)
+			options.threads = (int)value;
+		else if (strcmp(name, "--seed") == 0)
+			options.seed = value;
+		else if (strcmp(name, "--width") == 0)
+			options.width = (int)value;
+		else if (strcmp(name, "--height") == 0)
+			options.height = (int)value;
+		else if (strcmp(name, "--length") == 0)
+			options.length = (int)value;
+		else if (strcmp(name, "--growth") == 0)
+			options.growth = (int)value;
+		else if (strcmp(name, "--starve") == 0)
+			options.starveTicks = (int)value;
+		else if (strcmp(name, "--record-game") == 0)
+			options.recordGame = (unsigned int)value;
+		else if (strcmp(name, "--seek") == 0)
+			options.seekTick = value;
+		else {
+			cout << "ERROR::HEADLESS::UNKNOWN_OPTION " << name << endl;
+			return false;
+		}
+	}
+	//the snake starts in the middle facing up with its body below the head
+	if (options.width < 1 || options.height < 2 || options.length < 1 || options.height / 2 + options.length > options.height) {
+		cout << "ERROR::HEADLESS::SNAKE_DOES_NOT_FIT " << options.length << " on " << options.width << "x" << options.height << endl;
+		return false;
+	}
+	return true;
+}
+
+static bool readFile(const char* path, vector<unsigned char> &data)
+{
+	ifstream file(path, ios::binary);
+	if (!file) {
+		cout << "ERROR::HEADLESS::FILE_NOT_SUCCESSFULLY_READ " << path << endl;
+		return false;
+	}
+	data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	return true;
+}
+
+static bool writeFile(const char* path, const vector<unsigned char> &data)
+{
+	ofstream file(path, ios::binary);
+	if (!file || !file.write((const char*)&data[0], data.size())) {
+		cout << "ERROR::HEADLESS::FILE_NOT_SUCCESSFULLY_WRITTEN " << path << endl;
+		return false;
+	}
+	return true;
+}
+
+//seeks to the tick asked for, then fast-forwards to the end of the game
+static int playReplay(const HeadlessOptions &options)
+{
+	vector<unsigned char> data;
+	SnakeReplay replay;
+	if (!readFile(options.replayPath, data) || !replay.Load(data.empty() ? NULL : &data[0], data.size()))
+		return 1;
+	SnakeSim sim(replay.Width(), replay.Height());
+
+	auto start = chrono::steady_clock::now();
+	if (!replay.Seek(sim, options.seekTick))
+		return 1;
+	double seekSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	unsigned long long from = sim.Ticks();
+	start = chrono::steady_clock::now();
+	unsigned long long tick = replay.Play(sim, from, replay.Ticks());
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << fixed << setprecision(2);
+	cout << "replay         " << data.size() << " bytes, " << replay.Width() << "x" << replay.Height() << " grid, seed " << replay.Seed() << ", " << replay.Ticks()
+		<< " ticks, " << replay.Keyframes() << " keyframes" << endl;
+	cout << "seek           to tick " << from << " in " << seekSeconds * 1000.0 << " ms" << endl;
+	cout << "played         to tick " << tick << " in " << seconds * 1000.0 << " ms, " << (tick - from) / (seconds > 0.0 ? seconds : 1e-9) / 1e6 << " M ticks/s" << endl;
+	cout << "final          score " << sim.Score() << ", length " << sim.Length() << (sim.Alive() ? ", alive" : ", dead") << endl;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	HeadlessOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+	if (options.replayPath)
+		return playReplay(options);
+
+	JobSystem jobs(JobSystem::WorkersFor(options.threads));
+	unsigned int threads = jobs.ThreadCount();
+
+	const unsigned int GAMES_PER_PIECE = 64;
+	int maxScore = options.width * options.height;
+	HeadlessStats stats(maxScore);
+	mutex statsMutex;
+
+	auto start = chrono::steady_clock::now();
+	//each piece plays its games into its own stats and sim, then adds them to the total once
+	jobs.ParallelFor(0, options.games, GAMES_PER_PIECE, [&](unsigned int first, unsigned int last) {
+		SnakeSim sim(options.width, options.height);
+		HeadlessBots bots(options.width, options.height);
+		HeadlessStats local(maxScore);
+		for (unsigned int game = first; game < last; game++)
+			playGame(sim, bots, options, game, local);
+		lock_guard<mutex> lock(statsMutex);
+		stats.Add(local);
+	});
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	printStats(stats, options, threads, seconds);
+
+	//the game comes out the same played again on its own, this time with every tick recorded
+	if (options.recordPath) {
+		SnakeSim sim(options.width, options.height);
+		HeadlessBots bots(options.width, options.height);
+		HeadlessStats single(maxScore);
+		SnakeReplayRecorder recorder;
+		playGame(sim, bots, options, options.recordGame, single, &recorder);
+		vector<unsigned char> data;
+		recorder.Write(data);
+		if (!writeFile(options.recordPath, data))
+			return 1;
+		cout << "recorded       game " << options.recordGame << ", " << recorder.Ticks() << " ticks, score " << sim.Score() << ", " << data.size() << " bytes to "
+			<< options.recordPath << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,134 @@
+#include "ArenaGrid.h"
+
+#include <iostream>
+
+const int ArenaBitset::NONE;
+const int ArenaGrid::EGG_BLOCK_SHIFT;
+
+ArenaBitset::ArenaBitset() : chunksX(0), chunksZ(0)
+{
+}
+
+void ArenaBitset::Resize(int width, int height)
+{
+	chunksX = (width + ARENA_CHUNK_CELLS - 1) >> ARENA_CHUNK_SHIFT;
+	chunksZ = (height + ARENA_CHUNK_CELLS - 1) >> ARENA_CHUNK_SHIFT;
+	chunkOf.assign(chunksX * chunksZ, NONE);
+	Clear();
+}
+
+void ArenaBitset::Clear()
+{
+	for (size_t i = 0; i < chunkOf.size(); i++)
+		chunkOf[i] = NONE;
+	//every pool chunk is free and clear again
+	rows.assign(rows.size(), 0);
+	freeChunks.clear();
+	for (int i = (int)population.size() - 1; i >= 0; i--) {
+		population[i] = 0;
+		freeChunks.push_back(i);
+	}
+}
+
+void ArenaBitset::Set(int x, int z)
+{
+	int &chunk = chunkOf[(z >> ARENA_CHUNK_SHIFT) * chunksX + (x >> ARENA_CHUNK_SHIFT)];
+	if (chunk == NONE) {
+		if (!freeChunks.empty()) {
+			chunk = freeChunks.back();
+			freeChunks.pop_back();
+		}
+		else {
+			chunk = (int)population.size();
+			population.push_back(0);
+			rows.resize(rows.size() + ARENA_CHUNK_CELLS, 0);
+		}
+	}
+	uint64_t &row = rows[(chunk << ARENA_CHUNK_SHIFT) + (z & (ARENA_CHUNK_CELLS - 1))];
+	uint64_t bit = 1ull << (x & (ARENA_CHUNK_CELLS - 1));
+	if (row & bit)
+		return;
+	row |= bit;
+	population[chunk]++;
+}
+
+void ArenaBitset::Reset(int x, int z)
+{
+	int &chunk = chunkOf[(z >> ARENA_CHUNK_SHIFT) * chunksX + (x >> ARENA_CHUNK_SHIFT)];
+	if (chunk == NONE)
+		return;
+	uint64_t &row = rows[(chunk << ARENA_CHUNK_SHIFT) + (z & (ARENA_CHUNK_CELLS - 1))];
+	uint64_t bit = 1ull << (x & (ARENA_CHUNK_CELLS - 1));
+	if (!(row & bit))
+		return;
+	row &= ~bit;
+	//the last bit going means every row is 0 again, ready for whoever gets it next
+	if (--population[chunk] == 0) {
+		freeChunks.push_back(chunk);
+		chunk = NONE;
+	}
+}
+
+size_t ArenaBitset::Bytes() const
+{
+	return chunkOf.capacity() * sizeof(int) + rows.capacity() * sizeof(uint64_t) + population.capacity() * sizeof(int) + freeChunks.capacity() * sizeof(int);
+}
+
+ArenaGrid::ArenaGrid() : width(0), height(0), blocksX(0)
+{
+}
+
+void ArenaGrid::Resize(int width, int height)
+{
+	if (width < 1 || height < 1 || width > ARENA_MAX_SIDE || height > ARENA_MAX_SIDE)
+		std::cout << "ERROR::ARENA_GRID::SIZE_OUT_OF_RANGE " << width << "x" << height << std::endl;
+	this->width = width < 1 ? 1 : (width > ARENA_MAX_SIDE ? ARENA_MAX_SIDE : width);
+	this->height = height < 1 ? 1 : (height > ARENA_MAX_SIDE ? ARENA_MAX_SIDE : height);
+	occupied.Resize(this->width, this->height);
+	eggs.clear();
+	eggIndex.clear();
+	blocksX = (this->width + (1 << EGG_BLOCK_SHIFT) - 1) >> EGG_BLOCK_SHIFT;
+	blockEggs.assign((size_t)blocksX * ((this->height + (1 << EGG_BLOCK_SHIFT) - 1) >> EGG_BLOCK_SHIFT), 0);
+}
+
+void ArenaGrid::Clear()
+{
+	occupied.Clear();
+	eggs.clear();
+	eggIndex.clear();
+	blockEggs.assign(blockEggs.size(), 0);
+}
+
+bool ArenaGrid::AddEgg(int x, int z)
+{
+	int cell = z * width + x;
+	if (!eggIndex.insert(std::make_pair(cell, (int)eggs.size())).second)
+		return false;
+	eggs.push_back(cell);
+	blockEggs[blockOf(x, z)]++;
+	return true;
+}
+
+bool ArenaGrid::RemoveEgg(int x, int z)
+{
+	std::unordered_map<int, int>::iterator found = eggIndex.find(z * width + x);
+	if (found == eggIndex.end())
+		return false;
+	int index = found->second;
+	eggIndex.erase(found);
+	blockEggs[blockOf(x, z)]--;
+	//the last egg fills the gap
+	if (index != (int)eggs.size() - 1) {
+		eggs[index] = eggs.back();
+		eggIndex[eggs[index]] = index;
+	}
+	eggs.pop_back();
+	return true;
+}
+
+size_t ArenaGrid::Bytes() const
+{
+	//roughly, the map's nodes are a pointer or two and the pair each
+	return occupied.Bytes() + blockEggs.capacity() + eggs.capacity() * sizeof(int) + eggIndex.size() * (sizeof(std::pair<int, int>) + 2 * sizeof(void*))
+		+ eggIndex.bucket_count() * sizeof(void*);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// cells along each side of an arena chunk, a chunk is one 64 bit word per row
+const int ARENA_CHUNK_SHIFT = 6;
+const int ARENA_CHUNK_CELLS = 1 << ARENA_CHUNK_SHIFT;
+// the biggest side an arena can have, every cell index still fits in an int
+const int ARENA_MAX_SIDE = 4096;
+
+// One bit per cell of a grid of up to ARENA_MAX_SIDE a side, in 64x64 chunks that only exist while a bit in them is
+// set: an all clear chunk goes back to a free list and its table entry to NONE. A test is a table lookup and a
+// shift, memory follows how many chunks have something in them rather than the size of the grid.
+class ArenaBitset
+{
+public:
+	static const int NONE = -1;
+
+	ArenaBitset();
+
+	// every bit clear, the chunks already allocated are kept for reuse
+	void Resize(int width, int height);
+	void Clear();
+
+	bool Test(int x, int z) const;
+	void Set(int x, int z);
+	void Reset(int x, int z);
+
+	int ChunksX() const { return chunksX; }
+	int ChunksZ() const { return chunksZ; }
+	bool ChunkEmpty(int chunkX, int chunkZ) const { return chunkOf[chunkZ * chunksX + chunkX] == NONE; }
+	size_t ChunksInUse() const { return population.size() - freeChunks.size(); }
+	size_t Bytes() const;
+
+private:
+	int chunksX, chunksZ;
+	std::vector<int> chunkOf;		// per chunk, the pool chunk holding its bits or NONE
+	std::vector<uint64_t> rows;		// pool, ARENA_CHUNK_CELLS words a chunk
+	std::vector<int> population;	// bits set in each pool chunk
+	std::vector<int> freeChunks;
+};
+
+inline bool ArenaBitset::Test(int x, int z) const
+{
+	int chunk = chunkOf[(z >> ARENA_CHUNK_SHIFT) * chunksX + (x >> ARENA_CHUNK_SHIFT)];
+	return chunk != NONE && ((rows[(chunk << ARENA_CHUNK_SHIFT) + (z & (ARENA_CHUNK_CELLS - 1))] >> (x & (ARENA_CHUNK_CELLS - 1))) & 1);
+}
+
+// The world a crowd of snakes plays on, up to ARENA_MAX_SIDE cells a side: which cells have snake in them as an
+// ArenaBitset, and the eggs as a list for spawning and drawing with a hash from cell to place in it. Eggs are few
+// and scattered, a chunk each would cost more than the hash; a count of eggs per 8x8 block keeps most lookups away
+// from it. Nothing is stored per cell, so a 2048x2048 arena with a few hundred snakes costs about what those snakes cover.
+// Cells are indexed z * width + x like SnakeSim's.
+class ArenaGrid
+{
+public:
+	ArenaGrid();
+
+	// empty, sides are clamped to 1..ARENA_MAX_SIDE
+	void Resize(int width, int height);
+	void Clear();
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+	bool Inside(int x, int z) const { return (unsigned int)x < (unsigned int)width && (unsigned int)z < (unsigned int)height; }
+
+	bool Occupied(int x, int z) const { return occupied.Test(x, z); }
+	void Occupy(int x, int z) { occupied.Set(x, z); }
+	void Vacate(int x, int z) { occupied.Reset(x, z); }
+
+	bool HasEgg(int x, int z) const;
+	// false if there is an egg there already
+	bool AddEgg(int x, int z);
+	// false if there was no egg there
+	bool RemoveEgg(int x, int z);
+	size_t EggCount() const { return eggs.size(); }
+	// eggs in no particular order, removing one moves the last into its place
+	int EggCell(size_t i) const { return eggs[i]; }
+
+	const ArenaBitset &Occupancy() const { return occupied; }
+	size_t Bytes() const;
+
+private:
+	int width, height;
+	ArenaBitset occupied;
+	std::vector<int> eggs;
+	std::unordered_map<int, int> eggIndex; // cell to its place in eggs
+	std::vector<unsigned char> blockEggs;  // eggs in each EGG_BLOCK_SHIFT block
+	int blocksX;
+
+	static const int EGG_BLOCK_SHIFT = 3;
+	int blockOf(int x, int z) const { return (z >> EGG_BLOCK_SHIFT) * blocksX + (x >> EGG_BLOCK_SHIFT); }
+};
+
+inline bool ArenaGrid::HasEgg(int x, int z) const
+{
+	return blockEggs[blockOf(x, z)] > 0 && eggIndex.find(z * width + x) != eggIndex.end();
+}
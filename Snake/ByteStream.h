@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Little helpers for the compact binary formats (replays, keyframes). Varints are LEB128: 7 bits a byte, low
+// bits first, the top bit set on every byte but the last, so small numbers take one byte. Fixed64 is 8 bytes
+// little endian whatever the machine. The readers move data along and return false instead of reading past end.
+
+inline void WriteVarint(std::vector<unsigned char> &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((unsigned char)value);
+}
+
+inline bool ReadVarint(const unsigned char* &data, const unsigned char* end, uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && data < end; shift += 7) {
+		unsigned char byte = *data++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+// a varint that has to fit an int between 0 and limit
+inline bool ReadVarint(const unsigned char* &data, const unsigned char* end, int &value, int limit)
+{
+	uint64_t wide;
+	if (!ReadVarint(data, end, wide) || wide > (uint64_t)limit)
+		return false;
+	value = (int)wide;
+	return true;
+}
+
+inline void WriteFixed64(std::vector<unsigned char> &out, uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+		out.push_back((unsigned char)(value >> (i * 8)));
+}
+
+inline bool ReadFixed64(const unsigned char* &data, const unsigned char* end, uint64_t &value)
+{
+	if (end - data < 8)
+		return false;
+	value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= (uint64_t)*data++ << (i * 8);
+	return true;
+}
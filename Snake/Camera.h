@@ -7,6 +7,8 @@
 
 #include <vector>
 
+#include "Frustum.h"
+
 using namespace std;
 // Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
 enum Camera_Movement {
@@ -22,9 +24,14 @@ const float PITCH = 0.0f;
 const float SPEED = 2.5f;
 const float SENSITIVITY = 0.1f;
 const float ZOOM = 45.0f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
 
 
 // An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL
+// The view, projection and view-projection matrices and the frustum are cached and only rebuilt after something they depend on
+// changed. Every rebuild bumps Version(), so whoever consumes them (uniform uploads, culling) can skip its own work when it
+// hasn't changed. Change the attributes below through the member functions so the cache knows about it.
 class Camera
 {
 public:
@@ -43,7 +50,8 @@ public:
 	float Zoom;
 
 	// Constructor with vectors
-	Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+	Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM),
+		aspect(16.0f / 9.0f), nearPlane(NEAR_PLANE), farPlane(FAR_PLANE), viewDirty(true), projectionDirty(true), version(0)
 	{
 		Position = position;
 		WorldUp = up;
@@ -53,7 +61,8 @@ public:
 	}
 
 	// Constructor with scalar values
-	Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+	Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM),
+		aspect(16.0f / 9.0f), nearPlane(NEAR_PLANE), farPlane(FAR_PLANE), viewDirty(true), projectionDirty(true), version(0)
 	{
 		Position = glm::vec3(posX, posY, posZ);
 		WorldUp = glm::vec3(upX, upY, upZ);
@@ -63,21 +72,84 @@ public:
 	}
 
 	// Returns the view matrix calculated using Euler Angles and the LookAt Matrix
-	glm::mat4 GetViewMatrix()
+	const glm::mat4 &GetViewMatrix()
+	{
+		update();
+		return view;
+	}
+
+	const glm::mat4 &GetProjectionMatrix()
+	{
+		update();
+		return projection;
+	}
+
+	const glm::mat4 &GetViewProjectionMatrix()
 	{
-		return glm::lookAt(Position, Position + Front, Up);
+		update();
+		return viewProjection;
+	}
+
+	const Frustum &GetFrustum()
+	{
+		update();
+		return frustum;
+	}
+
+	// goes up by one every time the matrices actually change
+	unsigned int Version()
+	{
+		update();
+		return version;
 	}
 
 	void setPosition(float x, float y, float z) {
-		Position = glm::vec3(x, y, z);
+		glm::vec3 position(x, y, z);
+		if (position == Position)
+			return;
+		Position = position;
+		viewDirty = true;
 	}
 
 	void setAngle(float x, float y) {
+		if (x == Yaw && y == Pitch)
+			return;
 		Yaw = x;
 		Pitch = y;
 		updateCameraVectors();
 	}
 
+	// projection follows the real framebuffer shape, ignores a minimised (0 sized) window
+	void SetViewportSize(int width, int height)
+	{
+		if (width <= 0 || height <= 0)
+			return;
+		float newAspect = (float)width / (float)height;
+		if (newAspect == aspect)
+			return;
+		aspect = newAspect;
+		projectionDirty = true;
+	}
+
+	void SetClipPlanes(float nearDistance, float farDistance)
+	{
+		nearPlane = nearDistance;
+		farPlane = farDistance;
+		projectionDirty = true;
+	}
+
+	float GetAspect() const { return aspect; }
+
+	// world space ray through a point on screen given in normalised device coordinates, (0, 0) is the centre
+	void ScreenRay(float x, float y, glm::vec3 &origin, glm::vec3 &direction)
+	{
+		glm::mat4 inverseViewProjection = glm::inverse(GetViewProjectionMatrix());
+		glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		origin = glm::vec3(nearPoint) / nearPoint.w;
+		direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+	}
+
 	// Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
 	void ProcessKeyboard(Camera_Movement direction, float deltaTime)
 	{
@@ -90,11 +162,14 @@ public:
 			Position -= Right * velocity;
 		if (direction == RIGHT)
 			Position += Right * velocity;
+		viewDirty = true;
 	}
 
 	// Processes input received from a mouse input system. Expects the offset value in both the x and y direction.
 	void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true)
 	{
+		if (xoffset == 0.0f && yoffset == 0.0f)
+			return;
 		xoffset *= MouseSensitivity;
 		yoffset *= MouseSensitivity;
 
@@ -117,6 +192,7 @@ public:
 	// Processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
 	void ProcessMouseScroll(float yoffset)
 	{
+		projectionDirty = true;
 		if (Zoom >= 1.0f && Zoom <= 45.0f)
 			Zoom -= yoffset;
 		if (Zoom <= 1.0f)
@@ -126,6 +202,33 @@ public:
 	}
 
 private:
+	// Cached matrices
+	float aspect;
+	float nearPlane;
+	float farPlane;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	Frustum frustum;
+	bool viewDirty;
+	bool projectionDirty;
+	unsigned int version;
+
+	// Rebuilds whatever went stale since the last call
+	void update()
+	{
+		if (!viewDirty && !projectionDirty)
+			return;
+		if (viewDirty)
+			view = glm::lookAt(Position, Position + Front, Up);
+		if (projectionDirty)
+			projection = glm::perspective(glm::radians(Zoom), aspect, nearPlane, farPlane);
+		viewProjection = projection * view;
+		frustum = Frustum(viewProjection);
+		viewDirty = projectionDirty = false;
+		version++;
+	}
+
 	// Calculates the front vector from the Camera's (updated) Euler Angles
 	void updateCameraVectors()
 	{
@@ -138,6 +241,7 @@ private:
 		// Also re-calculate the Right and Up vector
 		Right = glm::normalize(glm::cross(Front, WorldUp));  // Normalize the vectors, because their length gets closer to 0 the more you look up or down which results in slower movement.
 		Up = glm::normalize(glm::cross(Right, Front));
+		viewDirty = true;
 	}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "DynamicResolution.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+//above this fraction of the budget we start giving resolution back
+const double HEADROOM = 0.85;
+//the most the scale moves per measured frame, dropping is allowed to be much quicker than recovering
+const float MAX_SCALE_DROP = 0.1f;
+const float MAX_SCALE_RISE = 0.02f;
+//scene size is rounded to this many pixels so tiny scale changes don't constantly change the size
+const int SIZE_STEP = 8;
+
+DynamicResolution::DynamicResolution() : enabled(true), minScale(0.5f), maxScale(1.0f), targetFrameTime(1.0 / 60.0),
+	scale(1.0f), smoothedFrameTime(0.0), fbo(0), colourTexture(0), depthBuffer(0), targetWidth(0), targetHeight(0),
+	windowWidth(0), windowHeight(0), sceneWidth(0), sceneHeight(0), queryIndex(0)
+{
+	for (int i = 0; i < QUERY_COUNT; i++) {
+		queries[i] = 0;
+		queryPending[i] = false;
+	}
+}
+
+void DynamicResolution::Configure(bool enabled, float minScale, float maxScale, double targetFrameTime)
+{
+	this->enabled = enabled;
+	this->minScale = std::max(0.1f, std::min(minScale, maxScale));
+	this->maxScale = std::max(this->minScale, maxScale);
+	this->targetFrameTime = targetFrameTime;
+	scale = std::max(this->minScale, std::min(scale, this->maxScale));
+	//force the target to be reallocated at the new maximum
+	targetWidth = targetHeight = 0;
+}
+
+void DynamicResolution::Init()
+{
+	glGenFramebuffers(1, &fbo);
+	glGenTextures(1, &colourTexture);
+	glGenRenderbuffers(1, &depthBuffer);
+	glGenQueries(QUERY_COUNT, queries);
+}
+
+void DynamicResolution::Shutdown()
+{
+	glDeleteQueries(QUERY_COUNT, queries);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteTextures(1, &colourTexture);
+	glDeleteFramebuffers(1, &fbo);
+}
+
+void DynamicResolution::allocate(int width, int height)
+{
+	targetWidth = width;
+	targetHeight = height;
+
+	glBindTexture(GL_TEXTURE_2D, colourTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colourTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		cout << "ERROR::FRAMEBUFFER:: dynamic resolution target is not complete" << endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::BeginScene(int windowWidth, int windowHeight)
+{
+	this->windowWidth = windowWidth;
+	this->windowHeight = windowHeight;
+
+	//the target is allocated once at the biggest size we may need, lower scales just use the corner of it
+	int maxWidth = std::max(1, (int)(windowWidth * maxScale));
+	int maxHeight = std::max(1, (int)(windowHeight * maxScale));
+	if (maxWidth != targetWidth || maxHeight != targetHeight)
+		allocate(maxWidth, maxHeight);
+
+	float frameScale = enabled ? scale : maxScale;
+	sceneWidth = std::min(targetWidth, std::max(SIZE_STEP, (int)(windowWidth * frameScale) / SIZE_STEP * SIZE_STEP));
+	sceneHeight = std::min(targetHeight, std::max(SIZE_STEP, (int)(windowHeight * frameScale) / SIZE_STEP * SIZE_STEP));
+
+	readQueries();
+	if (!queryPending[queryIndex]) {
+		glBeginQuery(GL_TIME_ELAPSED, queries[queryIndex]);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, sceneWidth, sceneHeight);
+}
+
+void DynamicResolution::EndScene()
+{
+	//stretch the used corner over the whole window
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	if (!queryPending[queryIndex]) {
+		glEndQuery(GL_TIME_ELAPSED);
+		queryPending[queryIndex] = true;
+	}
+	queryIndex = (queryIndex + 1) % QUERY_COUNT;
+}
+
+//collects every timer query the GPU has finished with, never waits for one
+void DynamicResolution::readQueries()
+{
+	for (int i = 0; i < QUERY_COUNT; i++) {
+		int slot = (queryIndex + i) % QUERY_COUNT;
+		if (!queryPending[slot])
+			continue;
+		GLint available = 0;
+		glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+		queryPending[slot] = false;
+		updateScale(nanoseconds * 1e-9);
+	}
+}
+
+void DynamicResolution::updateScale(double frameTime)
+{
+	//smooth out single frame spikes
+	smoothedFrameTime = smoothedFrameTime <= 0.0 ? frameTime : smoothedFrameTime + (frameTime - smoothedFrameTime) * 0.2;
+	if (!enabled || smoothedFrameTime <= 0.0)
+		return;
+
+	//cost goes with pixel count, i.e. scale squared
+	float desired = scale * (float)std::sqrt(targetFrameTime / smoothedFrameTime);
+	if (smoothedFrameTime > targetFrameTime)
+		scale = std::max(desired, scale - MAX_SCALE_DROP);
+	else if (smoothedFrameTime < targetFrameTime * HEADROOM)
+		scale = std::min(desired, scale + MAX_SCALE_RISE);
+	scale = std::max(minScale, std::min(scale, maxScale));
+}
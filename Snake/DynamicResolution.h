@@ -0,0 +1,51 @@
+#pragma once
+
+// Renders the 3D scene into an offscreen framebuffer whose resolution follows a frame time budget, then
+// stretches it over the window. The GPU time of every frame is measured with timer queries (read back a few
+// frames later so we never stall waiting on them); when frames run over budget the render scale drops, when
+// there is headroom it slowly climbs back. Fill rate cost goes with the pixel count, so the scale is moved by
+// the square root of how far over or under budget we are.
+// Only used on the render thread, all of it needs the GL context.
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+
+	// bounds and budget, can be changed any time
+	void Configure(bool enabled, float minScale, float maxScale, double targetFrameTime);
+
+	void Init();
+	void Shutdown();
+
+	// binds the offscreen target at this frame's resolution and sets the viewport to it
+	void BeginScene(int windowWidth, int windowHeight);
+	// upscales the scene into the window's framebuffer (left bound afterwards) and feeds the controller
+	void EndScene();
+
+	float Scale() const { return scale; }
+	int SceneWidth() const { return sceneWidth; }
+	int SceneHeight() const { return sceneHeight; }
+
+private:
+	static const int QUERY_COUNT = 4; // frames of timer queries in flight
+
+	bool enabled;
+	float minScale, maxScale;
+	double targetFrameTime;
+
+	float scale;
+	double smoothedFrameTime;
+
+	unsigned int fbo, colourTexture, depthBuffer;
+	int targetWidth, targetHeight;	// allocated size, the window size at maxScale
+	int windowWidth, windowHeight;
+	int sceneWidth, sceneHeight;	// part of the target used this frame
+
+	unsigned int queries[QUERY_COUNT];
+	bool queryPending[QUERY_COUNT];
+	int queryIndex;
+
+	void allocate(int width, int height);
+	void readQueries();
+	void updateScale(double frameTime);
+};
@@ -0,0 +1,95 @@
+#include "FloorGrid.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+FloorGrid::FloorGrid() : tilesX(0), tilesZ(0), chunksX(0), chunksZ(0), originX(0.0f), originZ(0.0f), tileSize(1.0f), layoutVersion(0)
+{
+}
+
+void FloorGrid::Resize(int tilesX, int tilesZ, float originX, float originZ, float tileSize)
+{
+	this->tilesX = tilesX > 0 ? tilesX : 0;
+	this->tilesZ = tilesZ > 0 ? tilesZ : 0;
+	this->originX = originX;
+	this->originZ = originZ;
+	this->tileSize = tileSize;
+	chunksX = (this->tilesX + FLOOR_CHUNK_TILES - 1) / FLOOR_CHUNK_TILES;
+	chunksZ = (this->tilesZ + FLOOR_CHUNK_TILES - 1) / FLOOR_CHUNK_TILES;
+	layoutVersion++;
+
+	//snapshots may still hold the old chunks, they go when the last one lets go
+	chunks.assign(chunksX * chunksZ, std::shared_ptr<FloorChunk>());
+}
+
+unsigned char FloorGrid::Get(int x, int z) const
+{
+	if (x < 0 || z < 0 || x >= tilesX || z >= tilesZ)
+		return 0;
+	const FloorChunk* chunk = chunks[(z / FLOOR_CHUNK_TILES) * chunksX + x / FLOOR_CHUNK_TILES].get();
+	return chunk ? chunk->tiles[(z % FLOOR_CHUNK_TILES) * FLOOR_CHUNK_TILES + x % FLOOR_CHUNK_TILES] : 0;
+}
+
+void FloorGrid::Set(int x, int z, unsigned char tile)
+{
+	if (x < 0 || z < 0 || x >= tilesX || z >= tilesZ)
+		return;
+	std::shared_ptr<FloorChunk> &chunk = chunks[(z / FLOOR_CHUNK_TILES) * chunksX + x / FLOOR_CHUNK_TILES];
+	if (!chunk) {
+		if (tile == 0)
+			return;
+		//a new chunk is never in a snapshot yet
+		chunk = std::make_shared<FloorChunk>();
+		memset(chunk->tiles, 0, sizeof(chunk->tiles));
+	}
+	unsigned char &current = chunk->tiles[(z % FLOOR_CHUNK_TILES) * FLOOR_CHUNK_TILES + x % FLOOR_CHUNK_TILES];
+	if (current == tile)
+		return;
+	//a snapshot (or the renderer) still has this one, so it gets a copy to keep and we write to a new one.
+	//only snapshots built on this thread ever add owners, so a count of 1 means nobody else can be reading it,
+	//the fence makes sure their last reads are done before we write
+	if (chunk.use_count() > 1) {
+		chunk = std::make_shared<FloorChunk>(*chunk);
+		chunk->tiles[(z % FLOOR_CHUNK_TILES) * FLOOR_CHUNK_TILES + x % FLOOR_CHUNK_TILES] = tile;
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	current = tile;
+}
+
+bool FloorGrid::TileAt(float worldX, float worldZ, int &x, int &z) const
+{
+	x = (int)std::floor((worldX - originX) / tileSize);
+	z = (int)std::floor((worldZ - originZ) / tileSize);
+	return x >= 0 && z >= 0 && x < tilesX && z < tilesZ;
+}
+
+size_t FloorGrid::ChunksAllocated() const
+{
+	size_t allocated = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+		allocated += chunks[i] ? 1 : 0;
+	return allocated;
+}
+
+void FloorGrid::CopyTo(FloorSnapshot &snapshot) const
+{
+	if (snapshot.layoutVersion != layoutVersion || snapshot.chunks.size() != chunks.size()) {
+		snapshot.layoutVersion = layoutVersion;
+		snapshot.tilesX = tilesX;
+		snapshot.tilesZ = tilesZ;
+		snapshot.chunksX = chunksX;
+		snapshot.chunksZ = chunksZ;
+		snapshot.originX = originX;
+		snapshot.originZ = originZ;
+		snapshot.tileSize = tileSize;
+		snapshot.chunks.assign(chunks.begin(), chunks.end());
+		return;
+	}
+	//comparing pointers is enough, a written chunk is always a new one once a snapshot had it
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (snapshot.chunks[i].get() != chunks[i].get())
+			snapshot.chunks[i] = chunks[i];
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// one attribute byte per tile: the low bits pick how the tile looks, the high ones are flags
+const unsigned char FLOOR_TILE_TYPE = 0x0F;
+const unsigned char FLOOR_TILE_HIGHLIGHT = 0x10;
+const unsigned char FLOOR_TILE_WALL = 0x20;
+
+// tiles along each side of a chunk, chunks are what gets culled, drawn and uploaded
+const int FLOOR_CHUNK_TILES = 32;
+
+struct FloorChunk {
+	unsigned char tiles[FLOOR_CHUNK_TILES * FLOOR_CHUNK_TILES]; // rows of x, one per z
+};
+
+// the floor as the render thread sees it, chunks in rows of x, one row per chunk z. a null chunk is all 0
+struct FloorSnapshot {
+	unsigned int layoutVersion; // changes when the size, origin or tile size do
+	int tilesX, tilesZ;
+	int chunksX, chunksZ;
+	float originX, originZ; // world corner of tile (0, 0), the floor is the y = 0 plane
+	float tileSize;
+	std::vector<std::shared_ptr<const FloorChunk> > chunks;
+
+	FloorSnapshot() : layoutVersion(0), tilesX(0), tilesZ(0), chunksX(0), chunksZ(0), originX(0.0f), originZ(0.0f), tileSize(1.0f) {}
+};
+
+// The arena floor as a grid of square tiles split into chunks. A chunk is never written while a snapshot still
+// holds it: Set copies it first. So the render thread can read the chunks without locking, and a chunk's pointer
+// changing means that chunk needs uploading again.
+// Chunks only get allocated when a tile in them is first set to something other than 0, so a huge floor that's
+// mostly plain costs its table of chunk pointers and the chunks with something on them.
+// Game thread only.
+class FloorGrid
+{
+public:
+	FloorGrid();
+
+	// throws every tile away (all 0 again), no chunks are allocated
+	void Resize(int tilesX, int tilesZ, float originX, float originZ, float tileSize);
+
+	unsigned char Get(int x, int z) const;
+	void Set(int x, int z, unsigned char tile);
+	void SetFlags(int x, int z, unsigned char flags) { Set(x, z, Get(x, z) | flags); }
+	void ClearFlags(int x, int z, unsigned char flags) { Set(x, z, Get(x, z) & ~flags); }
+
+	// tile under a world position, false when it's off the floor
+	bool TileAt(float worldX, float worldZ, int &x, int &z) const;
+
+	int TilesX() const { return tilesX; }
+	int TilesZ() const { return tilesZ; }
+
+	// brings a snapshot up to date, only chunks that changed since it was last filled are reassigned
+	void CopyTo(FloorSnapshot &snapshot) const;
+
+	size_t ChunksAllocated() const;
+
+private:
+	int tilesX, tilesZ;
+	int chunksX, chunksZ;
+	float originX, originZ;
+	float tileSize;
+	unsigned int layoutVersion;
+	std::vector<std::shared_ptr<FloorChunk> > chunks;
+};
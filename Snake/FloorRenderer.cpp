@@ -0,0 +1,198 @@
+#include "FloorRenderer.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+#include "Shader.h"
+
+FloorRenderer::FloorRenderer() : shader(NULL), quadVAO(0), quadVBO(0), instanceVBO(0), tileTexture(0), uploadedLayout(0), layoutUploaded(false),
+	instanceCapacity(0)
+{
+	for (unsigned int v = 0; v < MAX_FLOOR_VIEWS; v++) {
+		viewFirst[v] = 0;
+		viewCount[v] = 0;
+	}
+}
+
+void FloorRenderer::Init()
+{
+	shader = new Shader("floorShader.vs", "floorShader.fs");
+	//camera comes from the same ViewData binding point the other scene shaders use
+	glUniformBlockBinding(shader->ID, glGetUniformBlockIndex(shader->ID, "ViewData"), 0);
+	shader->use();
+	shader->setInt("texture1", 0);
+	shader->setInt("texture2", 1);
+	shader->setInt("tiles", 2);
+	shader->setFloat("chunkTiles", (float)FLOOR_CHUNK_TILES);
+
+	//one chunk sized quad, corners 0..1, as a triangle strip
+	float quadVertices[] = {
+		0.0f, 0.0f,
+		0.0f, 1.0f,
+		1.0f, 0.0f,
+		1.0f, 1.0f
+	};
+
+	glGenVertexArrays(1, &quadVAO);
+	glGenBuffers(1, &quadVBO);
+	glGenBuffers(1, &instanceVBO);
+
+	glBindVertexArray(quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+	//corner to location = 0
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	//chunk x/z to location = 1, one per instance, its pointer is set per view in Draw
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	glGenTextures(1, &tileTexture);
+	glBindTexture(GL_TEXTURE_2D, tileTexture);
+	//integer textures can't be filtered
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void FloorRenderer::Shutdown()
+{
+	glDeleteTextures(1, &tileTexture);
+	glDeleteBuffers(1, &instanceVBO);
+	glDeleteBuffers(1, &quadVBO);
+	glDeleteVertexArrays(1, &quadVAO);
+	delete shader;
+	shader = NULL;
+	uploaded.clear();
+	layoutUploaded = false;
+}
+
+void FloorRenderer::Update(const FloorSnapshot &floor)
+{
+	if (!layoutUploaded || floor.layoutVersion != uploadedLayout) {
+		//new size, a fresh texture of plain tiles, the chunks that exist get uploaded below
+		int texelsX = std::max(floor.tilesX, 1), texelsZ = std::max(floor.tilesZ, 1);
+		std::vector<unsigned char> plain((size_t)texelsX * texelsZ, 0);
+		glBindTexture(GL_TEXTURE_2D, tileTexture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, texelsX, texelsZ, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &plain[0]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		uploaded.assign(floor.chunks.size(), std::shared_ptr<const FloorChunk>());
+		uploadedLayout = floor.layoutVersion;
+		layoutUploaded = true;
+	}
+
+	bool bound = false;
+	for (int cz = 0; cz < floor.chunksZ; cz++) {
+		for (int cx = 0; cx < floor.chunksX; cx++) {
+			size_t index = cz * floor.chunksX + cx;
+			if (uploaded[index] == floor.chunks[index])
+				continue;
+			if (!bound) {
+				glBindTexture(GL_TEXTURE_2D, tileTexture);
+				//chunk rows are FLOOR_CHUNK_TILES bytes apart whatever part of them is used
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, FLOOR_CHUNK_TILES);
+				bound = true;
+			}
+			uploadChunk(floor, cx, cz);
+			//keeping a reference means the game can't reuse the memory, so a pointer compare stays honest
+			uploaded[index] = floor.chunks[index];
+		}
+	}
+	if (bound) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+}
+
+//the last chunk along each side can hang off the edge of the floor, only the part on it is uploaded
+void FloorRenderer::uploadChunk(const FloorSnapshot &floor, int chunkX, int chunkZ)
+{
+	int x = chunkX * FLOOR_CHUNK_TILES;
+	int z = chunkZ * FLOOR_CHUNK_TILES;
+	int width = std::min(FLOOR_CHUNK_TILES, floor.tilesX - x);
+	int height = std::min(FLOOR_CHUNK_TILES, floor.tilesZ - z);
+	static const FloorChunk plainChunk = {};
+	const FloorChunk* chunk = floor.chunks[chunkZ * floor.chunksX + chunkX].get();
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, z, width, height, GL_RED_INTEGER, GL_UNSIGNED_BYTE, (chunk ? chunk : &plainChunk)->tiles);
+}
+
+unsigned int FloorRenderer::Cull(const FloorSnapshot &floor, const Frustum* frusta, unsigned int frustumCount)
+{
+	frustumCount = std::min(frustumCount, MAX_FLOOR_VIEWS);
+
+	//flat chunks, so the sphere through its corners
+	float chunkSize = floor.tileSize * FLOOR_CHUNK_TILES;
+	float radius = chunkSize * 0.70710678f;
+	chunkSpheres.Clear();
+	for (int cz = 0; cz < floor.chunksZ; cz++) {
+		for (int cx = 0; cx < floor.chunksX; cx++)
+			chunkSpheres.Add(glm::vec3(floor.originX + (cx + 0.5f) * chunkSize, 0.0f, floor.originZ + (cz + 0.5f) * chunkSize), radius);
+	}
+	unsigned int visible = CullSpheresViews(frusta, frustumCount, chunkSpheres);
+
+	//each view's visible chunks as one run of instances
+	instances.clear();
+	for (unsigned int v = 0; v < frustumCount; v++) {
+		unsigned char viewBit = (unsigned char)(1 << v);
+		viewFirst[v] = (unsigned int)(instances.size() / 2);
+		size_t sphere = 0;
+		for (int cz = 0; cz < floor.chunksZ; cz++) {
+			for (int cx = 0; cx < floor.chunksX; cx++) {
+				if (!(chunkSpheres.visible[sphere++] & viewBit))
+					continue;
+				instances.push_back((float)cx);
+				instances.push_back((float)cz);
+			}
+		}
+		viewCount[v] = (unsigned int)(instances.size() / 2) - viewFirst[v];
+	}
+	for (unsigned int v = frustumCount; v < MAX_FLOOR_VIEWS; v++)
+		viewCount[v] = 0;
+
+	if (instances.empty())
+		return visible;
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	if (instances.size() > instanceCapacity) {
+		instanceCapacity = instances.size() * 2;
+		glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(float), NULL, GL_STREAM_DRAW);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(float), &instances[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return visible;
+}
+
+void FloorRenderer::Draw(const FloorSnapshot &floor, unsigned int view, unsigned int texture1, unsigned int texture2)
+{
+	if (view >= MAX_FLOOR_VIEWS || viewCount[view] == 0)
+		return;
+
+	shader->use();
+	shader->setVec2("origin", floor.originX, floor.originZ);
+	shader->setFloat("tileSize", floor.tileSize);
+	glUniform2i(glGetUniformLocation(shader->ID, "tileCount"), floor.tilesX, floor.tilesZ);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, texture2);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, tileTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	//no base instance in GL 3.3, so the view's run is picked by where the attribute starts reading
+	glBindVertexArray(quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(viewFirst[view] * 2 * sizeof(float)));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, viewCount[view]);
+	glBindVertexArray(0);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FloorGrid.h"
+#include "Frustum.h"
+
+class Shader;
+
+// Draws the arena floor as one instanced quad per visible chunk. The tiles' attribute bytes live in an integer
+// texture one texel per tile, the fragment shader looks its tile up from where it is on the floor, so the cost
+// goes with the chunks on screen and not with how big the arena is. Only chunks whose pointer changed since the
+// last frame get uploaded again.
+// Only used on the render thread, all of it needs the GL context.
+class FloorRenderer
+{
+public:
+	FloorRenderer();
+
+	void Init();
+	void Shutdown();
+
+	// brings the tile texture up to date with the snapshot
+	void Update(const FloorSnapshot &floor);
+	// culls the chunks against every view's frustum, returns how many chunk/view pairs are visible
+	unsigned int Cull(const FloorSnapshot &floor, const Frustum* frusta, unsigned int frustumCount);
+	// draws the chunks visible in view v, the ViewData block must already be bound to that view
+	void Draw(const FloorSnapshot &floor, unsigned int view, unsigned int texture1, unsigned int texture2);
+
+private:
+	static const unsigned int MAX_FLOOR_VIEWS = 8; // as many as CullSpheresViews handles
+
+	Shader* shader;
+	unsigned int quadVAO, quadVBO, instanceVBO;
+	unsigned int tileTexture;
+
+	// what the texture holds, for spotting what changed
+	unsigned int uploadedLayout;
+	bool layoutUploaded;
+	std::vector<std::shared_ptr<const FloorChunk> > uploaded;
+
+	SphereSet chunkSpheres;
+	// chunk x/z of every visible chunk, each view's run after the one before
+	std::vector<float> instances;
+	unsigned int viewFirst[MAX_FLOOR_VIEWS];
+	unsigned int viewCount[MAX_FLOOR_VIEWS];
+	size_t instanceCapacity; // floats the instance buffer has room for
+
+	void uploadChunk(const FloorSnapshot &floor, int chunkX, int chunkZ);
+};
@@ -0,0 +1,79 @@
+#include "FollowCamera.h"
+
+#include <algorithm>
+#include <cmath>
+
+//leave some room around the subject when zooming to fit
+const float FIT_MARGIN = 1.25f;
+
+FollowCamera::FollowCamera() : front(0.0f, 0.0f, -1.0f), stiffness(4.0f), lookAhead(8.0f), minDistance(40.0f), maxDistance(120.0f),
+	autoZoom(true), fitScale(1.0f), focus(0.0f), focusVelocity(0.0f), distance(40.0f), distanceVelocity(0.0f),
+	previousEye(0.0f), currentEye(0.0f)
+{
+}
+
+void FollowCamera::SetViewDirection(const glm::vec3 &front)
+{
+	this->front = front;
+}
+
+void FollowCamera::SetDistanceRange(float minDistance, float maxDistance)
+{
+	this->minDistance = minDistance;
+	this->maxDistance = std::max(minDistance, maxDistance);
+	distance = std::min(std::max(distance, this->minDistance), this->maxDistance);
+}
+
+void FollowCamera::SetFieldOfView(float verticalFovRadians, float aspect)
+{
+	//a sphere fits when it fits the narrower of the two half angles
+	float halfVertical = verticalFovRadians * 0.5f;
+	float halfHorizontal = std::atan(std::tan(halfVertical) * aspect);
+	fitScale = FIT_MARGIN / std::sin(std::min(halfVertical, halfHorizontal));
+}
+
+void FollowCamera::Start(const glm::vec3 &eye)
+{
+	focus = eye + front * distance;
+	focusVelocity = glm::vec3(0.0f);
+	distanceVelocity = 0.0f;
+	previousEye = currentEye = eye;
+}
+
+//exact step of a critically damped spring pulling value towards target, decay = exp(-stiffness * dt)
+//(the closed form solution of x'' = -k^2 (x - target) - 2k x', not an integration, so any dt is stable)
+template<typename T>
+static void springStep(T &value, T &velocity, const T &target, float stiffness, float dt, float decay)
+{
+	T offset = value - target;
+	T temp = (velocity + offset * stiffness) * dt;
+	velocity = (velocity - temp * stiffness) * decay;
+	value = target + (offset + temp) * decay;
+}
+
+void FollowCamera::Tick(float dt, const glm::vec3 &subject, const glm::vec3 &heading, float subjectRadius)
+{
+	glm::vec3 targetFocus = subject;
+	float headingLength = std::sqrt(glm::dot(heading, heading));
+	if (headingLength > 0.0f)
+		targetFocus += heading * (lookAhead / headingLength);
+
+	float targetDistance = minDistance;
+	if (autoZoom)
+		targetDistance = std::min(std::max(subjectRadius * fitScale, minDistance), maxDistance);
+
+	if (stiffness <= 0.0f) {
+		focus = targetFocus;
+		distance = targetDistance;
+		focusVelocity = glm::vec3(0.0f);
+		distanceVelocity = 0.0f;
+	}
+	else {
+		float decay = std::exp(-stiffness * dt);
+		springStep(focus, focusVelocity, targetFocus, stiffness, dt, decay);
+		springStep(distance, distanceVelocity, targetDistance, stiffness, dt, decay);
+	}
+
+	previousEye = currentEye;
+	currentEye = focus - front * distance;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Third person rig that chases a subject (the snake's head) from a fixed viewing direction. The point it looks
+// at leads the subject along its heading, and both that point and the distance to it follow their targets
+// through critically damped springs solved in closed form, so the motion is the same at any tick rate. Tick it
+// once per simulation step, then ask for the eye position between the last two ticks when drawing.
+class FollowCamera
+{
+public:
+	FollowCamera();
+
+	// direction the camera looks along, normalised. the rig never rotates
+	void SetViewDirection(const glm::vec3 &front);
+	// how fast the springs catch up, roughly 1 / seconds; 0 snaps straight to the target
+	void SetStiffness(float stiffness) { this->stiffness = stiffness; }
+	// how far ahead of the subject, along its heading, to look
+	void SetLookAhead(float distance) { lookAhead = distance; }
+	void SetDistanceRange(float minDistance, float maxDistance);
+	// auto zoom backs off until a sphere of the subject's radius fits on screen, needs the field of view
+	void SetAutoZoom(bool enabled) { autoZoom = enabled; }
+	void SetFieldOfView(float verticalFovRadians, float aspect);
+
+	// starts over from a given eye position, e.g. when switching to the rig, and glides from there
+	void Start(const glm::vec3 &eye);
+	// one simulation step. heading needn't be normalised, zero when the subject stands still
+	void Tick(float dt, const glm::vec3 &subject, const glm::vec3 &heading, float subjectRadius);
+	// alpha 0 is the previous tick, 1 the latest
+	glm::vec3 Eye(float alpha) const { return previousEye + (currentEye - previousEye) * alpha; }
+
+private:
+	glm::vec3 front;
+	float stiffness;
+	float lookAhead;
+	float minDistance, maxDistance;
+	bool autoZoom;
+	float fitScale; // distance per unit of subject radius that keeps it in frame
+
+	glm::vec3 focus, focusVelocity;
+	float distance, distanceVelocity;
+	glm::vec3 previousEye, currentEye;
+};
@@ -0,0 +1,84 @@
+#include "FramePacer.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+FramePacer::FramePacer(double targetFPS) : nextDeadline(0.0), sleepMean(0.002), sleepM2(0.0), sleepCount(1), sleepEstimate(0.002), redrawRequested(true)
+{
+#ifdef _WIN32
+	//default windows scheduler tick is ~15.6ms, ask for 1ms so short sleeps are usable
+	timeBeginPeriod(1);
+#endif
+	SetTargetFPS(targetFPS);
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetTargetFPS(double fps)
+{
+	targetFPS = fps;
+	framePeriod = fps > 0.0 ? 1.0 / fps : 0.0;
+	//start the schedule again from the next frame
+	nextDeadline = 0.0;
+}
+
+double FramePacer::GetTargetFPS() const
+{
+	return targetFPS;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	if (framePeriod <= 0.0)
+		return;
+
+	double current = now();
+	//first frame, or we fell more than a whole frame behind (hitch, breakpoint, window drag):
+	//don't try to catch up with a burst of frames, just restart the schedule from here
+	if (nextDeadline == 0.0 || current - nextDeadline > framePeriod)
+		nextDeadline = current;
+	nextDeadline += framePeriod;
+
+	waitUntil(nextDeadline);
+}
+
+double FramePacer::now()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::waitUntil(double deadline)
+{
+	//sleep in 1ms slices while the remaining time is comfortably bigger than a sleep usually takes
+	while (deadline - now() > sleepEstimate) {
+		double start = now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		double observed = now() - start;
+
+		//update the estimate with what that sleep really cost, pad it by one standard deviation
+		sleepCount++;
+		double delta = observed - sleepMean;
+		sleepMean += delta / sleepCount;
+		sleepM2 += delta * (observed - sleepMean);
+		sleepEstimate = sleepMean + std::sqrt(sleepM2 / (sleepCount - 1));
+	}
+
+	//spin the rest, it is well under a millisecond by now
+	while (now() < deadline)
+		std::this_thread::yield();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+// Paces the game loop to a target frame rate. The wait at the end of each frame sleeps in short slices
+// while there is plenty of time left and spins for the last stretch, so deadlines are hit to within a few
+// microseconds without burning a whole core. It also carries the redraw flag used by the idle menu screen.
+class FramePacer
+{
+public:
+	FramePacer(double targetFPS = 60.0);
+	~FramePacer();
+
+	// target frames per second, 0 or less means uncapped
+	void SetTargetFPS(double fps);
+	double GetTargetFPS() const;
+
+	// call once per frame after the buffers were swapped, blocks until the next frame is due
+	void WaitForNextFrame();
+
+	// idle mode: static screens only redraw when something asked for it (resize, expose, screen change)
+	void RequestRedraw() { redrawRequested = true; }
+	bool RedrawRequested() const { return redrawRequested; }
+	void ClearRedraw() { redrawRequested = false; }
+
+private:
+	double targetFPS;
+	double framePeriod;		// seconds per frame, 0 when uncapped
+	double nextDeadline;	// steady clock time the next frame is due at
+
+	// running estimate (Welford mean/variance) of how long a "1ms" sleep actually takes on this machine
+	double sleepMean;
+	double sleepM2;
+	long long sleepCount;
+	double sleepEstimate;
+
+	std::atomic<bool> redrawRequested;
+
+	static double now();
+	void waitUntil(double deadline);
+};
@@ -0,0 +1,189 @@
+#include "Frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_SSE 1
+#include <emmintrin.h>
+#endif
+
+Frustum::Frustum(const glm::mat4 &m)
+{
+	//glm is column major, so m[column][row]; each plane is the 4th row plus or minus one of the others
+	for (int i = 0; i < 3; i++) {
+		for (int side = 0; side < 2; side++) {
+			float sign = side == 0 ? 1.0f : -1.0f;
+			glm::vec4 &plane = planes[i * 2 + side];
+			plane.x = m[0][3] + sign * m[0][i];
+			plane.y = m[1][3] + sign * m[1][i];
+			plane.z = m[2][3] + sign * m[2][i];
+			plane.w = m[3][3] + sign * m[3][i];
+		}
+	}
+	//normalise so the plane distance is in world units and can be compared against a radius
+	for (int i = 0; i < 6; i++) {
+		glm::vec4 &plane = planes[i];
+		float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f)
+			plane = plane * (1.0f / length);
+	}
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3 &center, float radius) const
+{
+	for (int i = 0; i < 6; i++) {
+		const glm::vec4 &plane = planes[i];
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::IntersectsBox(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const
+{
+	for (int i = 0; i < 6; i++) {
+		const glm::vec4 &plane = planes[i];
+		//the corner furthest along the plane normal, if even that one is outside the whole box is
+		float px = plane.x >= 0.0f ? boxMax.x : boxMin.x;
+		float py = plane.y >= 0.0f ? boxMax.y : boxMin.y;
+		float pz = plane.z >= 0.0f ? boxMax.z : boxMin.z;
+		if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+unsigned int CullSpheres(const Frustum &frustum, SphereSet &set)
+{
+	size_t count = set.Size();
+	unsigned int visibleCount = 0;
+	size_t i = 0;
+
+#ifdef FRUSTUM_SSE
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++) {
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	//four spheres per iteration, one per lane
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(&set.x[i]);
+		__m128 y = _mm_loadu_ps(&set.y[i]);
+		__m128 z = _mm_loadu_ps(&set.z[i]);
+		__m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(&set.radius[i]));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+		int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++) {
+			unsigned char visible = (mask >> lane) & 1;
+			set.visible[i + lane] = visible;
+			visibleCount += visible;
+		}
+	}
+#endif
+
+	//leftovers (or everything without SSE)
+	for (; i < count; i++) {
+		bool visible = frustum.IntersectsSphere(glm::vec3(set.x[i], set.y[i], set.z[i]), set.radius[i]);
+		set.visible[i] = visible ? 1 : 0;
+		visibleCount += visible ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+unsigned int CullSpheresViews(const Frustum* frusta, unsigned int frustumCount, SphereSet &set)
+{
+	if (frustumCount == 1)
+		return CullSpheres(frusta[0], set);
+
+	//views looking through exactly the same frustum (split screen players stood together, a spectator
+	//copying a player) don't need testing twice
+	unsigned int source[8];
+	unsigned int uniqueMask = 0;
+	for (unsigned int v = 0; v < frustumCount; v++) {
+		source[v] = v;
+		for (unsigned int u = 0; u < v; u++) {
+			if (std::memcmp(frusta[u].planes, frusta[v].planes, sizeof(frusta[v].planes)) == 0) {
+				source[v] = source[u];
+				break;
+			}
+		}
+		if (source[v] == v)
+			uniqueMask |= 1u << v;
+	}
+
+	size_t count = set.Size();
+	size_t i = 0;
+
+#ifdef FRUSTUM_SSE
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(&set.x[i]);
+		__m128 y = _mm_loadu_ps(&set.y[i]);
+		__m128 z = _mm_loadu_ps(&set.z[i]);
+		__m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(&set.radius[i]));
+		unsigned char lanes[4] = { 0, 0, 0, 0 };
+		for (unsigned int v = 0; v < frustumCount; v++) {
+			if (!(uniqueMask & (1u << v)))
+				continue;
+			const Frustum &frustum = frusta[v];
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++) {
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.planes[p].x), x), _mm_mul_ps(_mm_set1_ps(frustum.planes[p].y), y)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.planes[p].z), z), _mm_set1_ps(frustum.planes[p].w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+			}
+			int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; lane++)
+				lanes[lane] |= (unsigned char)(((mask >> lane) & 1) << v);
+		}
+		for (int lane = 0; lane < 4; lane++)
+			set.visible[i + lane] = lanes[lane];
+	}
+#endif
+
+	for (; i < count; i++) {
+		glm::vec3 center(set.x[i], set.y[i], set.z[i]);
+		unsigned char bits = 0;
+		for (unsigned int v = 0; v < frustumCount; v++) {
+			if ((uniqueMask & (1u << v)) && frusta[v].IntersectsSphere(center, set.radius[i]))
+				bits |= (unsigned char)(1u << v);
+		}
+		set.visible[i] = bits;
+	}
+
+	//fill in the duplicates and count
+	unsigned int visibleCount = 0;
+	for (i = 0; i < count; i++) {
+		unsigned char bits = set.visible[i];
+		for (unsigned int v = 0; v < frustumCount; v++) {
+			if (source[v] != v && (bits & (1u << source[v])))
+				bits |= (unsigned char)(1u << v);
+		}
+		set.visible[i] = bits;
+		for (unsigned int v = 0; v < frustumCount; v++)
+			visibleCount += (bits >> v) & 1;
+	}
+	return visibleCount;
+}
+
+void TransformSphere(const glm::mat4 &transform, const glm::vec3 &center, float radius, glm::vec3 &worldCenter, float &worldRadius)
+{
+	glm::vec4 c = transform * glm::vec4(center, 1.0f);
+	worldCenter = glm::vec3(c.x, c.y, c.z);
+	//non-uniform scale stretches the sphere, the biggest axis scale keeps it conservative
+	float sx = glm::dot(glm::vec3(transform[0].x, transform[0].y, transform[0].z), glm::vec3(transform[0].x, transform[0].y, transform[0].z));
+	float sy = glm::dot(glm::vec3(transform[1].x, transform[1].y, transform[1].z), glm::vec3(transform[1].x, transform[1].y, transform[1].z));
+	float sz = glm::dot(glm::vec3(transform[2].x, transform[2].y, transform[2].z), glm::vec3(transform[2].x, transform[2].y, transform[2].z));
+	worldRadius = radius * std::sqrt(std::max(sx, std::max(sy, sz)));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// View frustum as six planes (left, right, bottom, top, near, far) pointing inwards, each stored as
+// (normal.xyz, distance) so a point p is inside a plane when dot(normal, p) + distance >= 0.
+struct Frustum {
+	glm::vec4 planes[6];
+
+	Frustum() {}
+	// extracts the planes straight out of a projection * view matrix (Gribb/Hartmann)
+	explicit Frustum(const glm::mat4 &viewProjection);
+
+	bool IntersectsSphere(const glm::vec3 &center, float radius) const;
+	bool IntersectsBox(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const;
+};
+
+// Bounding spheres laid out as separate arrays so the culling pass can test four at a time with SSE.
+// Cleared and refilled every frame, the arrays keep their capacity so this doesn't allocate once warmed up.
+struct SphereSet {
+	std::vector<float> x, y, z, radius;
+	std::vector<unsigned char> visible; // bit v set when visible in view v (just 0/1 with a single frustum)
+
+	void Clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+		visible.clear();
+	}
+
+	void Add(const glm::vec3 &center, float r)
+	{
+		x.push_back(center.x);
+		y.push_back(center.y);
+		z.push_back(center.z);
+		radius.push_back(r);
+		visible.push_back(0);
+	}
+
+	size_t Size() const { return radius.size(); }
+};
+
+// tests every sphere in the set against the frustum and fills in set.visible, returns how many are visible
+unsigned int CullSpheres(const Frustum &frustum, SphereSet &set);
+
+// several views at once: each group of four spheres is loaded once and tested against every frustum, and a view
+// whose frustum is identical to an earlier one just copies its result. sets bit v of set.visible for frustum v
+// (up to 8), returns the total number of visible sphere/view pairs
+unsigned int CullSpheresViews(const Frustum* frusta, unsigned int frustumCount, SphereSet &set);
+
+// world space bounding sphere of a local space sphere under an affine transform
+void TransformSphere(const glm::mat4 &transform, const glm::vec3 &center, float radius, glm::vec3 &worldCenter, float &worldRadius);
@@ -0,0 +1,87 @@
+#pragma once
+
+// Buffers input between the glfw callbacks and the game. Key/button presses go into a fixed size ring buffer
+// stamped with the time they happened, so the simulation can consume them tick by tick in the order they were
+// pressed, and presses shorter than a frame are never lost. Mouse look and scroll only ever need their sum, so
+// they are coalesced instead of queued and sampled by the camera right before the view matrix is built.
+// Everything here is touched from the main thread only (glfw callbacks run inside glfwPollEvents).
+
+enum InputEventType {
+	INPUT_KEY_PRESS,
+	INPUT_KEY_RELEASE,
+	INPUT_MOUSE_PRESS,
+	INPUT_MOUSE_RELEASE
+};
+
+struct InputEvent {
+	InputEventType type;
+	int code;		// glfw key or mouse button
+	double time;	// glfwGetTime() when the callback fired
+};
+
+class InputQueue
+{
+public:
+	static const unsigned int CAPACITY = 256; // power of two so the indices can wrap with a mask
+
+	InputQueue() : head(0), tail(0), lookX(0.0f), lookY(0.0f), lookTime(-1.0), scroll(0.0f) {}
+
+	// adds an event, if the game stopped reading for so long that the ring is full the oldest event is dropped
+	void Push(InputEventType type, int code, double time)
+	{
+		if (head - tail == CAPACITY)
+			tail++;
+		InputEvent &e = events[head & (CAPACITY - 1)];
+		e.type = type;
+		e.code = code;
+		e.time = time;
+		head++;
+	}
+
+	bool Empty() const { return head == tail; }
+
+	// looks at the oldest event without removing it
+	const InputEvent &Peek() const { return events[tail & (CAPACITY - 1)]; }
+
+	void Pop() { tail++; }
+
+	// mouse look, summed until the camera takes it
+	void AddLook(float xoffset, float yoffset, double time)
+	{
+		if (lookTime < 0.0)
+			lookTime = time;
+		lookX += xoffset;
+		lookY += yoffset;
+	}
+
+	// hands over the summed look offsets and the time of the oldest movement in them
+	bool TakeLook(float &xoffset, float &yoffset, double &time)
+	{
+		if (lookTime < 0.0)
+			return false;
+		xoffset = lookX;
+		yoffset = lookY;
+		time = lookTime;
+		lookX = lookY = 0.0f;
+		lookTime = -1.0;
+		return true;
+	}
+
+	void AddScroll(float yoffset) { scroll += yoffset; }
+
+	float TakeScroll()
+	{
+		float s = scroll;
+		scroll = 0.0f;
+		return s;
+	}
+
+private:
+	InputEvent events[CAPACITY];
+	unsigned int head;	// next slot to write, only ever increases (wraps at 2^32 which is fine with the mask)
+	unsigned int tail;	// next slot to read
+
+	float lookX, lookY;
+	double lookTime;
+	float scroll;
+};
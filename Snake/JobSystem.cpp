@@ -0,0 +1,267 @@
+#include "JobSystem.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+//which worker of which system we are, set once when a worker starts. the thread that creates a system is told
+//apart by its id instead, it may have created others too
+static thread_local const JobSystem* t_system = NULL;
+static thread_local unsigned int t_threadIndex = 0;
+
+//failed attempts to find work before an idle worker goes to sleep
+const int IDLE_SPINS = 64;
+
+void WorkStealingQueue::Push(Job* job)
+{
+	long long b = bottom.load(std::memory_order_relaxed);
+	//release so a thief that reads this slot also sees everything written into the job
+	jobs[b & (CAPACITY - 1)].store(job, std::memory_order_release);
+	//the job has to be visible before a thief can see the new bottom
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+Job* WorkStealingQueue::Pop()
+{
+	long long b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long t = top.load(std::memory_order_relaxed);
+
+	if (t > b) {
+		//empty, put bottom back
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return NULL;
+	}
+
+	Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (t == b) {
+		//last job left, race any thief for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = NULL;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* WorkStealingQueue::Steal()
+{
+	long long t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+		return NULL;
+
+	Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_acquire);
+	//someone else (the owner or another thief) got there first
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return NULL;
+	return job;
+}
+
+JobSystem::JobSystem(int workerCount) : creator(std::this_thread::get_id()), running(true), queuedJobs(0), sleepingWorkers(0)
+{
+	if (workerCount < 0) {
+		int hardware = (int)std::thread::hardware_concurrency();
+		workerCount = hardware > 1 ? hardware - 1 : 0;
+	}
+
+	for (int i = 0; i <= workerCount; i++) {
+		ThreadState* state = new ThreadState();
+		state->jobPool = new Job[JOB_POOL_SIZE];
+		for (unsigned int j = 0; j < JOB_POOL_SIZE; j++)
+			state->jobPool[j].unfinishedJobs.store(0, std::memory_order_relaxed);
+		state->allocated = 0;
+		state->stealSeed = 2654435761u * (i + 1);
+		threads.push_back(state);
+	}
+
+	for (int i = 1; i <= workerCount; i++)
+		workers.push_back(std::thread(&JobSystem::workerMain, this, (unsigned int)i));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	wakeUp.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	for (size_t i = 0; i < threads.size(); i++) {
+		delete[] threads[i]->jobPool;
+		delete threads[i];
+	}
+}
+
+JobSystem::ThreadState* JobSystem::currentThread() const
+{
+	if (t_system == this)
+		return threads[t_threadIndex];
+	if (std::this_thread::get_id() != creator)
+		cout << "ERROR::JOBSYSTEM:: jobs used from a thread that isn't part of the job system" << endl;
+	return threads[0];
+}
+
+Job* JobSystem::allocateJob()
+{
+	ThreadState* state = currentThread();
+	//walk the ring to the next slot whose job has finished, a parent waiting on its children is still alive
+	for (unsigned int i = 0; i < JOB_POOL_SIZE; i++) {
+		Job* job = &state->jobPool[state->allocated++ & (JOB_POOL_SIZE - 1)];
+		if (job->unfinishedJobs.load(std::memory_order_acquire) <= 0)
+			return job;
+	}
+	cout << "ERROR::JOBSYSTEM:: more than " << JOB_POOL_SIZE << " jobs alive on one thread" << endl;
+	return &state->jobPool[state->allocated++ & (JOB_POOL_SIZE - 1)];
+}
+
+Job* JobSystem::CreateJob(JobFunction function)
+{
+	return CreateJob(function, NULL, 0);
+}
+
+Job* JobSystem::CreateJob(JobFunction function, const void* data, size_t size)
+{
+	Job* job = allocateJob();
+	job->function = function;
+	job->parent = NULL;
+	job->unfinishedJobs.store(1, std::memory_order_relaxed);
+	if (size > JOB_DATA_SIZE) {
+		cout << "ERROR::JOBSYSTEM:: job data of " << size << " bytes doesn't fit in a job" << endl;
+		size = JOB_DATA_SIZE;
+	}
+	if (size > 0)
+		memcpy(job->data, data, size);
+	return job;
+}
+
+Job* JobSystem::CreateJobAsChild(Job* parent, JobFunction function)
+{
+	return CreateJobAsChild(parent, function, NULL, 0);
+}
+
+Job* JobSystem::CreateJobAsChild(Job* parent, JobFunction function, const void* data, size_t size)
+{
+	parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+	Job* job = CreateJob(function, data, size);
+	job->parent = parent;
+	return job;
+}
+
+void JobSystem::Run(Job* job)
+{
+	ThreadState* state = currentThread();
+	//deque is full, nobody is keeping up anyway so just do it now
+	if (state->queue.Full()) {
+		execute(job);
+		return;
+	}
+	state->queue.Push(job);
+	//seq_cst on both counters so a worker about to sleep either sees this job or we see it sleeping
+	queuedJobs.fetch_add(1);
+	if (sleepingWorkers.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wakeUp.notify_one();
+	}
+}
+
+void JobSystem::Wait(const Job* job)
+{
+	while (!IsFinished(job)) {
+		Job* next = getJob();
+		if (next)
+			execute(next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+Job* JobSystem::getJob()
+{
+	ThreadState* state = currentThread();
+	Job* job = state->queue.Pop();
+	if (!job) {
+		//own deque is empty, try someone else's, starting at a random thread so thieves spread out
+		unsigned int count = (unsigned int)threads.size();
+		state->stealSeed ^= state->stealSeed << 13;
+		state->stealSeed ^= state->stealSeed >> 17;
+		state->stealSeed ^= state->stealSeed << 5;
+		unsigned int start = state->stealSeed % count;
+		for (unsigned int i = 0; i < count && !job; i++) {
+			ThreadState* victim = threads[(start + i) % count];
+			if (victim != state)
+				job = victim->queue.Steal();
+		}
+	}
+	if (job)
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::execute(Job* job)
+{
+	job->function(job, job->data);
+	finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+	//read the parent first, once the count hits zero the owning thread may hand the slot out again
+	Job* parent = job->parent;
+	int unfinished = job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+	if (unfinished == 0 && parent)
+		finish(parent);
+}
+
+void JobSystem::workerMain(unsigned int index)
+{
+	t_system = this;
+	t_threadIndex = index;
+
+	int idle = 0;
+	while (running.load(std::memory_order_relaxed)) {
+		Job* job = getJob();
+		if (job) {
+			execute(job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < IDLE_SPINS) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		//nothing to do for a while, sleep until Run queues something
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers++;
+		wakeUp.wait(lock, [this] { return queuedJobs.load() > 0 || !running.load(); });
+		sleepingWorkers--;
+		idle = 0;
+	}
+}
+
+void JobSystem::parallelForJob(Job* job, const void* data)
+{
+	const ParallelForData* range = static_cast<const ParallelForData*>(data);
+	if (range->end - range->begin <= range->grainSize) {
+		range->invoke(range->body, range->begin, range->end);
+		return;
+	}
+
+	//split in half, each half becomes a child job that splits further
+	unsigned int middle = range->begin + (range->end - range->begin) / 2;
+	ParallelForData left = *range;
+	left.end = middle;
+	ParallelForData right = *range;
+	right.begin = middle;
+
+	JobSystem* system = range->system;
+	system->Run(system->CreateJobAsChild(job, &parallelForJob, &left, sizeof(left)));
+	system->Run(system->CreateJobAsChild(job, &parallelForJob, &right, sizeof(right)));
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing job scheduler.
+//
+// Every thread taking part (the thread that created the JobSystem plus its workers) owns a Chase-Lev deque
+// and a ring of preallocated jobs. A thread pushes and pops jobs at the bottom of its own deque without any
+// locking, idle threads steal from the top of someone else's. Jobs can be created as children of another job;
+// a parent only counts as finished once all its children have, so waiting on one root job waits for a whole
+// tree of work. Waiting never blocks, the waiting thread keeps running jobs until the one it waits for is done.
+//
+// Jobs come from a per-thread ring of preallocated slots, a slot is reused once its job has finished, so a
+// thread can have at most JOB_POOL_SIZE jobs alive at once and a Job* is only valid until its job is finished
+// (waiting on it from the thread that created it is always fine). Only the creating thread and the workers may create, run or wait for
+// jobs (the render thread for example must not). One thread can create several JobSystems and use each of them.
+
+struct Job;
+typedef void (*JobFunction)(Job* job, const void* data);
+
+const size_t JOB_SIZE = 128; // two cache lines, so jobs on different threads never share one
+const size_t JOB_DATA_SIZE = JOB_SIZE - sizeof(JobFunction) - sizeof(Job*) - sizeof(std::atomic<int>);
+
+struct alignas(64) Job {
+	JobFunction function;
+	Job* parent;
+	std::atomic<int> unfinishedJobs; // this job plus its unfinished children
+	char data[JOB_DATA_SIZE];		 // copied in at creation, handed to the function
+};
+
+// fixed size Chase-Lev deque, owner works at the bottom, thieves take from the top
+class WorkStealingQueue
+{
+public:
+	static const long long CAPACITY = 4096; // power of two
+
+	WorkStealingQueue() : top(0), bottom(0) {}
+
+	bool Full() const { return bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed) >= CAPACITY; }
+
+	// owner thread only
+	void Push(Job* job);
+	Job* Pop();
+	// any thread
+	Job* Steal();
+
+private:
+	std::atomic<long long> top;
+	char padding[64 - sizeof(std::atomic<long long>)]; // keep thieves' and owner's counters on separate lines
+	std::atomic<long long> bottom;
+	std::atomic<Job*> jobs[CAPACITY];
+};
+
+class JobSystem
+{
+public:
+	static const unsigned int JOB_POOL_SIZE = 4096; // jobs each thread can have alive at once, power of two
+
+	// workerCount -1 means one worker per hardware thread besides the calling one, 0 runs everything on the caller
+	JobSystem(int workerCount = -1);
+	~JobSystem();
+
+	// the workerCount for a number of threads in total, as options count them: -1 every hardware thread, 0 or 1 only
+	// the calling one
+	static int WorkersFor(int threads) { return threads < 0 ? -1 : (threads > 1 ? threads - 1 : 0); }
+
+	// threads taking part, including the one that created the system
+	unsigned int ThreadCount() const { return (unsigned int)threads.size(); }
+
+	Job* CreateJob(JobFunction function);
+	Job* CreateJob(JobFunction function, const void* data, size_t size);
+	Job* CreateJobAsChild(Job* parent, JobFunction function);
+	Job* CreateJobAsChild(Job* parent, JobFunction function, const void* data, size_t size);
+
+	// queues the job on the calling thread's deque
+	void Run(Job* job);
+	// runs other jobs until this one and all its children are finished
+	void Wait(const Job* job);
+	bool IsFinished(const Job* job) const { return job->unfinishedJobs.load(std::memory_order_acquire) <= 0; }
+
+	// calls body(first, last) over [begin, end) split into pieces of at most grainSize, and waits for all of them.
+	// the range is halved recursively so the pieces spread across the deques and idle threads steal big halves.
+	template<typename Body>
+	void ParallelFor(unsigned int begin, unsigned int end, unsigned int grainSize, const Body &body);
+
+private:
+	struct ThreadState {
+		WorkStealingQueue queue;
+		Job* jobPool;
+		unsigned int allocated;
+		unsigned int stealSeed;
+	};
+
+	std::vector<ThreadState*> threads; // [0] is the creating thread
+	std::thread::id creator;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running;
+
+	// sleeping support so idle workers don't burn a core each
+	std::atomic<int> queuedJobs;
+	std::atomic<int> sleepingWorkers;
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	ThreadState* currentThread() const;
+	Job* allocateJob();
+	Job* getJob();
+	void execute(Job* job);
+	void finish(Job* job);
+	void workerMain(unsigned int index);
+
+	struct ParallelForData {
+		const void* body;
+		void (*invoke)(const void* body, unsigned int first, unsigned int last);
+		JobSystem* system;
+		unsigned int begin, end, grainSize;
+	};
+	static void parallelForJob(Job* job, const void* data);
+
+	template<typename Body>
+	static void invokeBody(const void* body, unsigned int first, unsigned int last)
+	{
+		(*static_cast<const Body*>(body))(first, last);
+	}
+};
+
+template<typename Body>
+void JobSystem::ParallelFor(unsigned int begin, unsigned int end, unsigned int grainSize, const Body &body)
+{
+	if (begin >= end)
+		return;
+	ParallelForData data;
+	data.body = &body;
+	data.invoke = &invokeBody<Body>;
+	data.system = this;
+	data.begin = begin;
+	data.end = end;
+	data.grainSize = grainSize > 0 ? grainSize : 1;
+	Job* root = CreateJob(&parallelForJob, &data, sizeof(data));
+	Run(root);
+	Wait(root);
+}
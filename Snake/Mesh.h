@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "MeshBVH.h"
 #include "Shader.h"
 
 #include <string>
@@ -12,6 +13,9 @@
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 using namespace std;
 
 struct Vertex {
@@ -41,6 +45,15 @@ public:
 	vector<Texture> textures;
 	unsigned int VAO;
 
+	/*  Bounds (local space, computed once at import)  */
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	glm::vec3 sphereCenter;
+	float sphereRadius;
+
+	/*  Triangles for ray casts and collision, read only once built so it can be shared with the game thread  */
+	shared_ptr<const MeshBVH> bvh;
+
 	/*  Functions  */
 	// constructor
 	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
@@ -49,6 +62,9 @@ public:
 		this->indices = indices;
 		this->textures = textures;
 
+		computeBounds();
+		buildBVH();
+
 		// now that we have all the required data, set the vertex buffers and its attribute pointers.
 		setupMesh();
 	}
@@ -96,6 +112,39 @@ private:
 	unsigned int VBO, EBO;
 
 	/*  Functions    */
+	// axis aligned box around all vertices, and a sphere centred on the box reaching the furthest vertex
+	// (tighter than the box's own bounding sphere for most meshes)
+	void computeBounds()
+	{
+		if (vertices.empty()) {
+			boundsMin = boundsMax = sphereCenter = glm::vec3(0.0f);
+			sphereRadius = 0.0f;
+			return;
+		}
+		boundsMin = boundsMax = vertices[0].Position;
+		for (unsigned int i = 1; i < vertices.size(); i++) {
+			boundsMin = glm::min(boundsMin, vertices[i].Position);
+			boundsMax = glm::max(boundsMax, vertices[i].Position);
+		}
+		sphereCenter = (boundsMin + boundsMax) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (unsigned int i = 0; i < vertices.size(); i++) {
+			glm::vec3 offset = vertices[i].Position - sphereCenter;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		sphereRadius = std::sqrt(radiusSquared);
+	}
+
+	void buildBVH()
+	{
+		vector<glm::vec3> positions(vertices.size());
+		for (unsigned int i = 0; i < vertices.size(); i++)
+			positions[i] = vertices[i].Position;
+		shared_ptr<MeshBVH> built = make_shared<MeshBVH>();
+		built->Build(positions, indices);
+		bvh = built;
+	}
+
 	// initializes all the buffer objects/arrays
 	void setupMesh()
 	{
@@ -0,0 +1,394 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+
+//binned SAH: candidate split planes per axis
+const int SAH_BINS = 12;
+//stops the tree getting deeper than the fixed traversal stacks below can hold
+const int MAX_DEPTH = 60;
+const int STACK_SIZE = 64;
+
+static float area(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+	glm::vec3 e = boundsMax - boundsMin;
+	return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+void MeshBVH::Build(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices)
+{
+	unsigned int count = (unsigned int)(indices.size() / 3);
+	triangles.resize(count);
+	nodes.assign(count > 0 ? count * 2 : 2, BVHNode());
+	nodesUsed = 2;
+
+	std::vector<glm::vec3> centroids(count);
+	std::vector<unsigned int> order(count);
+	for (unsigned int i = 0; i < count; i++) {
+		BVHTriangle &tri = triangles[i];
+		tri.v0 = positions[indices[i * 3]];
+		tri.v1 = positions[indices[i * 3 + 1]];
+		tri.v2 = positions[indices[i * 3 + 2]];
+		centroids[i] = (tri.v0 + tri.v1 + tri.v2) * (1.0f / 3.0f);
+		order[i] = i;
+	}
+
+	BVHNode &root = nodes[0];
+	root.leftFirst = 0;
+	root.count = count;
+	if (count == 0) {
+		root.boundsMin = root.boundsMax = glm::vec3(0.0f);
+		triangleIds.clear();
+		return;
+	}
+	subdivide(0, centroids, order, 0);
+
+	//copy the triangles out in the order the leaves reference them
+	std::vector<BVHTriangle> sorted(count);
+	for (unsigned int i = 0; i < count; i++)
+		sorted[i] = triangles[order[i]];
+	triangles.swap(sorted);
+	triangleIds.swap(order);
+}
+
+void MeshBVH::subdivide(unsigned int nodeIndex, std::vector<glm::vec3> &centroids, std::vector<unsigned int> &order, int depth)
+{
+	BVHNode &node = nodes[nodeIndex];
+
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+	glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+		const BVHTriangle &tri = triangles[order[i]];
+		boundsMin = glm::min(boundsMin, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+		boundsMax = glm::max(boundsMax, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+		centroidMin = glm::min(centroidMin, centroids[order[i]]);
+		centroidMax = glm::max(centroidMax, centroids[order[i]]);
+	}
+	node.boundsMin = boundsMin;
+	node.boundsMax = boundsMax;
+	if (node.count <= 2 || depth >= MAX_DEPTH)
+		return;
+
+	//best split over SAH_BINS buckets along each axis
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = FLT_MAX;
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.0f)
+			continue;
+		float scale = SAH_BINS / extent;
+
+		glm::vec3 binMin[SAH_BINS], binMax[SAH_BINS];
+		unsigned int binCount[SAH_BINS];
+		for (int b = 0; b < SAH_BINS; b++) {
+			binMin[b] = glm::vec3(FLT_MAX);
+			binMax[b] = glm::vec3(-FLT_MAX);
+			binCount[b] = 0;
+		}
+		for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+			const BVHTriangle &tri = triangles[order[i]];
+			int b = std::min(SAH_BINS - 1, (int)((centroids[order[i]][axis] - centroidMin[axis]) * scale));
+			binCount[b]++;
+			binMin[b] = glm::min(binMin[b], glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+			binMax[b] = glm::max(binMax[b], glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+		}
+
+		//sweep from both ends so every plane's cost is O(1)
+		float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+		unsigned int leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+		glm::vec3 leftMin(FLT_MAX), leftMax(-FLT_MAX), rightMin(FLT_MAX), rightMax(-FLT_MAX);
+		unsigned int leftSum = 0, rightSum = 0;
+		for (int b = 0; b < SAH_BINS - 1; b++) {
+			leftSum += binCount[b];
+			leftMin = glm::min(leftMin, binMin[b]);
+			leftMax = glm::max(leftMax, binMax[b]);
+			leftCount[b] = leftSum;
+			leftArea[b] = leftSum ? area(leftMin, leftMax) : 0.0f;
+
+			int r = SAH_BINS - 1 - b;
+			rightSum += binCount[r];
+			rightMin = glm::min(rightMin, binMin[r]);
+			rightMax = glm::max(rightMax, binMax[r]);
+			rightCount[r - 1] = rightSum;
+			rightArea[r - 1] = rightSum ? area(rightMin, rightMax) : 0.0f;
+		}
+		for (int b = 0; b < SAH_BINS - 1; b++) {
+			float cost = leftCount[b] * leftArea[b] + rightCount[b] * rightArea[b];
+			if (leftCount[b] && rightCount[b] && cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b;
+			}
+		}
+	}
+
+	//not splitting at all is cheaper
+	if (bestAxis < 0 || bestCost >= node.count * area(boundsMin, boundsMax))
+		return;
+
+	float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+	float scale = SAH_BINS / extent;
+	unsigned int i = node.leftFirst;
+	unsigned int j = node.leftFirst + node.count;
+	while (i < j) {
+		int b = std::min(SAH_BINS - 1, (int)((centroids[order[i]][bestAxis] - centroidMin[bestAxis]) * scale));
+		if (b <= bestSplit)
+			i++;
+		else
+			std::swap(order[i], order[--j]);
+	}
+	unsigned int leftCount = i - node.leftFirst;
+	if (leftCount == 0 || leftCount == node.count)
+		return;
+
+	unsigned int left = nodesUsed;
+	nodesUsed += 2;
+	nodes[left].leftFirst = node.leftFirst;
+	nodes[left].count = leftCount;
+	nodes[left + 1].leftFirst = i;
+	nodes[left + 1].count = node.count - leftCount;
+	node.leftFirst = left;
+	node.count = 0;
+
+	subdivide(left, centroids, order, depth + 1);
+	subdivide(left + 1, centroids, order, depth + 1);
+}
+
+//distance along the ray to where it enters the box, FLT_MAX for a miss
+static float rayBox(const BVHNode &node, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float maxT)
+{
+	glm::vec3 t0 = (node.boundsMin - origin) * inverseDirection;
+	glm::vec3 t1 = (node.boundsMax - origin) * inverseDirection;
+	glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+//Moller-Trumbore
+static bool rayTriangle(const BVHTriangle &tri, const glm::vec3 &origin, const glm::vec3 &direction, float &t, float &u, float &v)
+{
+	glm::vec3 edge1 = tri.v1 - tri.v0, edge2 = tri.v2 - tri.v0;
+	glm::vec3 h = glm::cross(direction, edge2);
+	float det = glm::dot(edge1, h);
+	if (det > -1e-12f && det < 1e-12f)
+		return false;
+	float inverseDet = 1.0f / det;
+	glm::vec3 s = origin - tri.v0;
+	u = glm::dot(s, h) * inverseDet;
+	if (u < 0.0f || u > 1.0f)
+		return false;
+	glm::vec3 q = glm::cross(s, edge1);
+	v = glm::dot(direction, q) * inverseDet;
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+	t = glm::dot(edge2, q) * inverseDet;
+	return true;
+}
+
+static float safeInverse(float d)
+{
+	return d != 0.0f ? 1.0f / d : FLT_MAX;
+}
+
+bool MeshBVH::Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxT, RayHit &hit) const
+{
+	if (triangles.empty())
+		return false;
+
+	glm::vec3 inverseDirection(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+	bool found = false;
+	float closest = maxT;
+
+	unsigned int stack[STACK_SIZE];
+	int top = 0;
+	if (rayBox(nodes[0], origin, inverseDirection, closest) == FLT_MAX)
+		return false;
+	stack[top++] = 0;
+
+	while (top > 0) {
+		const BVHNode &node = nodes[stack[--top]];
+		if (node.count > 0) {
+			for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+				float t, u, v;
+				if (rayTriangle(triangles[i], origin, direction, t, u, v) && t >= 0.0f && t <= closest) {
+					closest = t;
+					hit.t = t;
+					hit.u = u;
+					hit.v = v;
+					hit.triangle = triangleIds[i];
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		//visit the nearer child first, the far one is often skipped once something closer got hit
+		float nearT = rayBox(nodes[node.leftFirst], origin, inverseDirection, closest);
+		float farT = rayBox(nodes[node.leftFirst + 1], origin, inverseDirection, closest);
+		unsigned int nearChild = node.leftFirst, farChild = node.leftFirst + 1;
+		if (farT < nearT) {
+			std::swap(nearT, farT);
+			std::swap(nearChild, farChild);
+		}
+		if (farT != FLT_MAX)
+			stack[top++] = farChild;
+		if (nearT != FLT_MAX)
+			stack[top++] = nearChild;
+	}
+	return found;
+}
+
+//closest point on a triangle to p (Ericson, Real-Time Collision Detection 5.1.5)
+static glm::vec3 closestPointOnTriangle(const glm::vec3 &p, const BVHTriangle &tri)
+{
+	const glm::vec3 &a = tri.v0, &b = tri.v1, &c = tri.v2;
+	glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+	float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return a;
+
+	glm::vec3 bp = p - b;
+	float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return b;
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return a + ab * (d1 / (d1 - d3));
+
+	glm::vec3 cp = p - c;
+	float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return c;
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return a + ac * (d2 / (d2 - d6));
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	float denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+//squared distance between segments p1-q1 and p2-q2 (Ericson 5.1.9)
+static float segmentSegmentDistanceSquared(const glm::vec3 &p1, const glm::vec3 &q1, const glm::vec3 &p2, const glm::vec3 &q2)
+{
+	glm::vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+	float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+	float s, t;
+	if (a <= 1e-12f && e <= 1e-12f) {
+		s = t = 0.0f;
+	}
+	else if (a <= 1e-12f) {
+		s = 0.0f;
+		t = glm::clamp(f / e, 0.0f, 1.0f);
+	}
+	else {
+		float c = glm::dot(d1, r);
+		if (e <= 1e-12f) {
+			t = 0.0f;
+			s = glm::clamp(-c / a, 0.0f, 1.0f);
+		}
+		else {
+			float b = glm::dot(d1, d2);
+			float denom = a * e - b * b;
+			s = denom != 0.0f ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+			t = (b * s + f) / e;
+			if (t < 0.0f) {
+				t = 0.0f;
+				s = glm::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else if (t > 1.0f) {
+				t = 1.0f;
+				s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+			}
+		}
+	}
+	glm::vec3 offset = (p1 + d1 * s) - (p2 + d2 * t);
+	return glm::dot(offset, offset);
+}
+
+static float pointTriangleDistanceSquared(const glm::vec3 &p, const BVHTriangle &tri)
+{
+	glm::vec3 offset = closestPointOnTriangle(p, tri) - p;
+	return glm::dot(offset, offset);
+}
+
+//either the segment passes through the triangle, or the closest pair involves a segment end or a triangle edge
+static float segmentTriangleDistanceSquared(const glm::vec3 &a, const glm::vec3 &b, const BVHTriangle &tri)
+{
+	float t, u, v;
+	if (rayTriangle(tri, a, b - a, t, u, v) && t >= 0.0f && t <= 1.0f)
+		return 0.0f;
+	float best = std::min(pointTriangleDistanceSquared(a, tri), pointTriangleDistanceSquared(b, tri));
+	best = std::min(best, segmentSegmentDistanceSquared(a, b, tri.v0, tri.v1));
+	best = std::min(best, segmentSegmentDistanceSquared(a, b, tri.v1, tri.v2));
+	best = std::min(best, segmentSegmentDistanceSquared(a, b, tri.v2, tri.v0));
+	return best;
+}
+
+bool MeshBVH::OverlapsSphere(const glm::vec3 &center, float radius) const
+{
+	if (triangles.empty())
+		return false;
+
+	float radiusSquared = radius * radius;
+	unsigned int stack[STACK_SIZE];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const BVHNode &node = nodes[stack[--top]];
+		glm::vec3 offset = glm::clamp(center, node.boundsMin, node.boundsMax) - center;
+		if (glm::dot(offset, offset) > radiusSquared)
+			continue;
+		if (node.count == 0) {
+			stack[top++] = node.leftFirst + 1;
+			stack[top++] = node.leftFirst;
+			continue;
+		}
+		for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+			if (pointTriangleDistanceSquared(center, triangles[i]) <= radiusSquared)
+				return true;
+		}
+	}
+	return false;
+}
+
+bool MeshBVH::OverlapsCapsule(const glm::vec3 &a, const glm::vec3 &b, float radius) const
+{
+	if (triangles.empty())
+		return false;
+
+	//boxes grown by the radius against the bare segment, conservative at the corners which is fine for culling
+	glm::vec3 direction = b - a;
+	glm::vec3 inverseDirection(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+	glm::vec3 grow(radius);
+	float radiusSquared = radius * radius;
+
+	unsigned int stack[STACK_SIZE];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const BVHNode &node = nodes[stack[--top]];
+		BVHNode grown = node;
+		grown.boundsMin -= grow;
+		grown.boundsMax += grow;
+		if (rayBox(grown, a, inverseDirection, 1.0f) == FLT_MAX)
+			continue;
+		if (node.count == 0) {
+			stack[top++] = node.leftFirst + 1;
+			stack[top++] = node.leftFirst;
+			continue;
+		}
+		for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+			if (segmentTriangleDistanceSquared(a, b, triangles[i]) <= radiusSquared)
+				return true;
+		}
+	}
+	return false;
+}
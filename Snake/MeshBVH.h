@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// 32 bytes, so a pair of siblings shares one cache line
+struct BVHNode {
+	glm::vec3 boundsMin;
+	unsigned int leftFirst; // leaf: first triangle, interior: left child (the right one is leftFirst + 1)
+	glm::vec3 boundsMax;
+	unsigned int count; // triangles in a leaf, 0 for interior nodes
+};
+
+struct BVHTriangle {
+	glm::vec3 v0, v1, v2;
+};
+
+struct RayHit {
+	float t; // distance along the ray in units of the direction's length
+	unsigned int triangle; // index of the triangle in the mesh's index buffer (first index / 3)
+	float u, v; // barycentrics of the hit
+};
+
+// Bounding volume hierarchy over a triangle mesh for ray casts and overlap tests against the real geometry.
+// Built top down with binned SAH, then stored flat: siblings sit next to each other in one array and the
+// triangles are copied out in leaf order, so a traversal walks memory mostly forwards. Read only once built,
+// so any number of threads can query one at the same time.
+class MeshBVH
+{
+public:
+	MeshBVH() : nodesUsed(0) {}
+
+	void Build(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices);
+
+	// nearest hit along origin + t * direction for t in [0, maxT], direction doesn't have to be normalised
+	bool Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxT, RayHit &hit) const;
+	bool OverlapsSphere(const glm::vec3 &center, float radius) const;
+	// capsule: every point within radius of the segment a-b
+	bool OverlapsCapsule(const glm::vec3 &a, const glm::vec3 &b, float radius) const;
+
+	bool Empty() const { return triangles.empty(); }
+	size_t TriangleCount() const { return triangles.size(); }
+	size_t NodeCount() const { return nodesUsed; }
+	const glm::vec3 &BoundsMin() const { return nodes[0].boundsMin; }
+	const glm::vec3 &BoundsMax() const { return nodes[0].boundsMax; }
+
+private:
+	std::vector<BVHNode> nodes; // [0] is the root, [1] is left empty so sibling pairs line up
+	unsigned int nodesUsed;
+	std::vector<BVHTriangle> triangles; // in leaf order
+	std::vector<unsigned int> triangleIds; // leaf order -> original triangle
+
+	void subdivide(unsigned int nodeIndex, std::vector<glm::vec3> &centroids, std::vector<unsigned int> &order, int depth);
+};
@@ -12,6 +12,7 @@
 #include <assimp/postprocess.h>
 
 #include "Mesh.h"
+#include "SceneGraph.h"
 #include "Shader.h"
 
 #include <string>
@@ -30,6 +31,7 @@ public:
 	/*  Model Data */
 	vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
 	vector<Mesh> meshes;
+	vector<ModelNode> nodes;	// assimp's node hierarchy with its transforms, parents before children
 	string directory;
 	bool gammaCorrection;
 
@@ -65,28 +67,44 @@ private:
 		directory = path.substr(0, path.find_last_of('/'));
 
 		// process ASSIMP's root node recursively
-		processNode(scene->mRootNode, scene);
+		processNode(scene->mRootNode, scene, -1);
 	}
 
 	// processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-	void processNode(aiNode *node, const aiScene *scene)
+	// the node itself is kept too, so its transform and place in the hierarchy aren't lost.
+	void processNode(aiNode *node, const aiScene *scene, int parent)
 	{
+		ModelNode modelNode;
+		modelNode.name = node->mName.C_Str();
+		modelNode.parent = parent;
+		modelNode.transform = toGlm(node->mTransformation);
 		// process each mesh located at the current node
 		for (unsigned int i = 0; i < node->mNumMeshes; i++)
 		{
 			// the node object only contains indices to index the actual objects in the scene. 
 			// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
 			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+			modelNode.meshes.push_back((unsigned int)meshes.size());
 			meshes.push_back(processMesh(mesh, scene));
 		}
+		// added before its children so a parent always comes first
+		int index = (int)nodes.size();
+		nodes.push_back(modelNode);
 		// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
 		for (unsigned int i = 0; i < node->mNumChildren; i++)
 		{
-			processNode(node->mChildren[i], scene);
+			processNode(node->mChildren[i], scene, index);
 		}
 
 	}
 
+	// assimp matrices are row major, glm's are column major
+	static glm::mat4 toGlm(const aiMatrix4x4 &m)
+	{
+		return glm::mat4(glm::vec4(m.a1, m.b1, m.c1, m.d1), glm::vec4(m.a2, m.b2, m.c2, m.d2),
+			glm::vec4(m.a3, m.b3, m.c3, m.d3), glm::vec4(m.a4, m.b4, m.c4, m.d4));
+	}
+
 	Mesh processMesh(aiMesh *mesh, const aiScene *scene)
 	{
 		// data to fill
@@ -0,0 +1,221 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+//corner order and the 12 triangles of a box, corner i has x from bit 0, y from bit 1, z from bit 2
+static const int BOX_TRIANGLES[36] = {
+	0, 1, 3, 0, 3, 2, // -z
+	4, 6, 7, 4, 7, 5, // +z
+	0, 4, 5, 0, 5, 1, // -y
+	2, 3, 7, 2, 7, 6, // +y
+	0, 2, 6, 0, 6, 4, // -x
+	1, 5, 7, 1, 7, 3  // +x
+};
+
+static void boxCorners(const glm::mat4 &mvp, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, glm::vec4* corners)
+{
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+		corners[i] = mvp * glm::vec4(corner, 1.0f);
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer() : depth(WIDTH * HEIGHT, 1.0f), viewProjection(1.0f)
+{
+	for (int i = 0; i < TILES_X * TILES_Y; i++)
+		tileMax[i] = 1.0f;
+}
+
+void OcclusionBuffer::Clear(const glm::mat4 &viewProjection)
+{
+	this->viewProjection = viewProjection;
+	std::fill(depth.begin(), depth.end(), 1.0f);
+}
+
+void OcclusionBuffer::RasterizeBox(const glm::mat4 &model, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+	glm::vec4 corners[8];
+	boxCorners(viewProjection * model, boundsMin, boundsMax, corners);
+	for (int i = 0; i < 36; i += 3)
+		RasterizeTriangle(corners[BOX_TRIANGLES[i]], corners[BOX_TRIANGLES[i + 1]], corners[BOX_TRIANGLES[i + 2]]);
+}
+
+void OcclusionBuffer::RasterizeTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+{
+	//only the near plane needs real clipping, the screen bounds are handled by the rasteriser's bounding box.
+	//Sutherland-Hodgman against z >= -w leaves at most 4 vertices
+	const glm::vec4 in[3] = { a, b, c };
+	glm::vec4 out[4];
+	int count = 0;
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4 &from = in[i], &to = in[(i + 1) % 3];
+		float fromDistance = from.z + from.w, toDistance = to.z + to.w;
+		if (fromDistance >= 0.0f)
+			out[count++] = from;
+		if ((fromDistance >= 0.0f) != (toDistance >= 0.0f)) {
+			float t = fromDistance / (fromDistance - toDistance);
+			out[count++] = from + (to - from) * t;
+		}
+	}
+	if (count >= 3)
+		rasterizeClipped(out, count);
+}
+
+void OcclusionBuffer::rasterizeClipped(const glm::vec4* vertices, int count)
+{
+	//to window coordinates, pixel centres at .5
+	glm::vec3 screen[4];
+	for (int i = 0; i < count; i++) {
+		float inverseW = 1.0f / vertices[i].w;
+		screen[i] = glm::vec3((vertices[i].x * inverseW * 0.5f + 0.5f) * WIDTH,
+			(vertices[i].y * inverseW * 0.5f + 0.5f) * HEIGHT,
+			vertices[i].z * inverseW * 0.5f + 0.5f);
+	}
+	rasterizeScreen(screen[0], screen[1], screen[2]);
+	if (count == 4)
+		rasterizeScreen(screen[0], screen[2], screen[3]);
+}
+
+void OcclusionBuffer::rasterizeScreen(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2)
+{
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+	if (std::fabs(area) < 1e-8f)
+		return;
+
+	int minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+	int maxX = std::min(WIDTH - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+	int minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+	int maxY = std::min(HEIGHT - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+	if (minX > maxX || minY > maxY)
+		return;
+	minX &= ~3; //whole groups of four
+
+	//edge functions, flipped for clockwise triangles so inside is always >= 0
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	float a0 = (v1.y - v2.y) * sign, b0 = (v2.x - v1.x) * sign, c0 = (v1.x * v2.y - v2.x * v1.y) * sign;
+	float a1 = (v2.y - v0.y) * sign, b1 = (v0.x - v2.x) * sign, c1 = (v2.x * v0.y - v0.x * v2.y) * sign;
+	float a2 = (v0.y - v1.y) * sign, b2 = (v1.x - v0.x) * sign, c2 = (v0.x * v1.y - v1.x * v0.y) * sign;
+
+	//depth as a plane over the screen, z/w is linear in window space
+	float inverseArea = 1.0f / (area * sign);
+	float zA = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * inverseArea;
+	float zB = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * inverseArea;
+	float zC = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * inverseArea;
+
+#ifdef OCCLUSION_SSE
+	const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		float* row = &depth[y * WIDTH];
+		for (int x = minX; x <= maxX; x += 4) {
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), _mm_set1_ps(b0 * py + c0));
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), _mm_set1_ps(b1 * py + c1));
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), _mm_set1_ps(b2 * py + c2));
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+			__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), _mm_set1_ps(zB * py + zC));
+			__m128 old = _mm_loadu_ps(row + x);
+			__m128 nearer = _mm_min_ps(old, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+		}
+	}
+#else
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		float* row = &depth[y * WIDTH];
+		for (int x = minX; x <= maxX; x++) {
+			float px = x + 0.5f;
+			if (a0 * px + b0 * py + c0 < 0.0f || a1 * px + b1 * py + c1 < 0.0f || a2 * px + b2 * py + c2 < 0.0f)
+				continue;
+			row[x] = std::min(row[x], zA * px + zB * py + zC);
+		}
+	}
+#endif
+}
+
+void OcclusionBuffer::Finish()
+{
+	//furthest depth in every tile, a box nearer than that in every tile it covers can't be hidden
+	for (int ty = 0; ty < TILES_Y; ty++) {
+		for (int tx = 0; tx < TILES_X; tx++) {
+			float furthest = 0.0f;
+			for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++) {
+				const float* row = &depth[y * WIDTH + tx * TILE_SIZE];
+				for (int x = 0; x < TILE_SIZE; x++)
+					furthest = std::max(furthest, row[x]);
+			}
+			tileMax[ty * TILES_X + tx] = furthest;
+		}
+	}
+}
+
+bool OcclusionBuffer::TestBox(const glm::mat4 &model, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const
+{
+	glm::vec4 corners[8];
+	boxCorners(viewProjection * model, boundsMin, boundsMax, corners);
+
+	//screen rectangle and nearest depth of the box, anything crossing the near plane is just treated as visible
+	float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, nearest = 1.0f;
+	for (int i = 0; i < 8; i++) {
+		if (corners[i].w <= 1e-5f || corners[i].z < -corners[i].w)
+			return true;
+		float inverseW = 1.0f / corners[i].w;
+		float x = (corners[i].x * inverseW * 0.5f + 0.5f) * WIDTH;
+		float y = (corners[i].y * inverseW * 0.5f + 0.5f) * HEIGHT;
+		float z = corners[i].z * inverseW * 0.5f + 0.5f;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearest = std::min(nearest, z);
+	}
+
+	int x0 = std::max(0, (int)std::floor(minX)), x1 = std::min(WIDTH - 1, (int)std::ceil(maxX));
+	int y0 = std::max(0, (int)std::floor(minY)), y1 = std::min(HEIGHT - 1, (int)std::ceil(maxY));
+	if (x0 > x1 || y0 > y1)
+		return false; //off screen, frustum culling normally catches these first
+
+	//coarse level first: hidden for sure if the box is behind the furthest depth of every tile it touches
+	bool maybeVisible = false;
+	for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE && !maybeVisible; ty++) {
+		for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+			if (nearest <= tileMax[ty * TILES_X + tx]) {
+				maybeVisible = true;
+				break;
+			}
+		}
+	}
+	if (!maybeVisible)
+		return false;
+
+	//then the pixels, four at a time. the row is widened to whole groups of four, which only errs on visible
+	x0 &= ~3;
+#ifdef OCCLUSION_SSE
+	const __m128 boxDepth = _mm_set1_ps(nearest);
+	for (int y = y0; y <= y1; y++) {
+		const float* row = &depth[y * WIDTH];
+		for (int x = x0; x <= x1; x += 4) {
+			if (_mm_movemask_ps(_mm_cmple_ps(boxDepth, _mm_loadu_ps(row + x))) != 0)
+				return true;
+		}
+	}
+#else
+	for (int y = y0; y <= y1; y++) {
+		const float* row = &depth[y * WIDTH];
+		for (int x = x0; x <= x1; x++) {
+			if (nearest <= row[x])
+				return true;
+		}
+	}
+#endif
+	return false;
+}
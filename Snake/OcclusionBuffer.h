@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Small software depth buffer for occlusion culling on the CPU. A handful of big occluders get rasterised into
+// it, four pixels at a time with SSE, then bounding boxes are tested against it before anything is sent to GL.
+// A coarser level holding the furthest depth of every 8x8 tile lets most boxes that are hidden be rejected
+// without touching single pixels. Depth is window z in [0, 1], 1 being the far plane.
+class OcclusionBuffer
+{
+public:
+	static const int WIDTH = 256;
+	static const int HEIGHT = 128;
+	static const int TILE_SIZE = 8;
+	static const int TILES_X = WIDTH / TILE_SIZE;
+	static const int TILES_Y = HEIGHT / TILE_SIZE;
+
+	OcclusionBuffer();
+
+	// starts a frame: everything at the far plane
+	void Clear(const glm::mat4 &viewProjection);
+	// the 12 triangles of a box, corners given in model space
+	void RasterizeBox(const glm::mat4 &model, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+	void RasterizeTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c); // clip space
+	// call once all occluders are in, before testing
+	void Finish();
+
+	// false only when the whole box is certainly behind what was rasterised
+	bool TestBox(const glm::mat4 &model, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const;
+
+private:
+	std::vector<float> depth; // WIDTH * HEIGHT, row by row
+	float tileMax[TILES_X * TILES_Y];
+	glm::mat4 viewProjection;
+
+	void rasterizeClipped(const glm::vec4* vertices, int count);
+	void rasterizeScreen(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c);
+};
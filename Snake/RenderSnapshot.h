@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "FloorGrid.h"
+#include "Frustum.h"
+
+// Everything the render thread needs to draw one frame. The game thread fills one of these in per frame and
+// hands it over through a TripleBuffer, after that it is never touched by the game again, so the render
+// thread can read it without any locking. The vectors are cleared rather than freed between frames so once
+// they have grown to the size of the scene, building a snapshot doesn't allocate.
+
+enum RenderModel {
+	RENDER_MODEL_EGG,
+	RENDER_MODEL_YOSHI,
+	RENDER_MODEL_COUNT
+};
+
+// the meshes of one node of a model, transform is that node's world transform
+struct DrawItem {
+	RenderModel model;
+	int node;
+	glm::mat4 transform;
+};
+
+// split screen / spectator views drawn in one frame
+const unsigned int MAX_VIEWS = 4;
+
+// one camera's view of the scene, drawn into a rectangle of the window given as fractions of its size
+struct RenderView {
+	// cameraVersion changes whenever any of view, projection, frustum or viewPos do
+	unsigned int cameraVersion;
+	glm::mat4 view;
+	glm::mat4 projection;
+	Frustum frustum;
+	glm::vec3 viewPos;
+	glm::vec4 viewport; // x, y, width, height, (0, 0) is the bottom left
+};
+
+// something big enough to hide things behind it, rasterised into the occlusion buffer as its bounding box
+struct Occluder {
+	glm::mat4 transform;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+struct RenderSnapshot {
+	unsigned long long frame;
+	bool menu;
+
+	// framebuffer size this frame should be drawn at
+	int width;
+	int height;
+
+	// cameras, views[0] is the main one
+	RenderView views[MAX_VIEWS];
+	unsigned int viewCount;
+
+	// lighting
+	glm::vec3 lightPos;
+	glm::vec3 lightColour;
+
+	// arena floor, its chunks are shared with the game's FloorGrid and never written while shared
+	FloorSnapshot floor;
+	std::vector<DrawItem> draws;
+	std::vector<Occluder> occluders;
+
+	// glfwGetTime() of the oldest input this frame is the first to show, -1 if it shows none
+	double inputTime;
+};
@@ -0,0 +1,495 @@
+#include "Renderer.h"
+
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Shader.h"
+#include "Model.h"
+
+using namespace std;
+
+unsigned int loadTexture(char const * path);
+
+//seconds the render thread sleeps waiting for a snapshot before checking if it should quit
+const double SNAPSHOT_WAIT_TIMEOUT = 0.1;
+
+Renderer::Renderer() : window(NULL), running(false), framesPresented(0), inputLatencyMs(-1.0), meshesVisible(0), meshesCulled(0), meshesOccluded(0),
+	shaderProgram1(NULL), lightShader(NULL), viewportWidth(0), viewportHeight(0),
+	modelsLoaded(false), viewUBO(0), viewStride(0), uploadedViewCount(0)
+{
+	for (int i = 0; i < RENDER_MODEL_COUNT; i++)
+		models[i] = NULL;
+	for (unsigned int v = 0; v < MAX_VIEWS; v++) {
+		viewUploaded[v] = false;
+		uploadedCameraVersion[v] = 0;
+	}
+}
+
+Renderer::~Renderer()
+{
+	Stop();
+}
+
+void Renderer::Start(GLFWwindow* window, const RenderSettings &settings)
+{
+	this->window = window;
+	this->settings = settings;
+	running = true;
+	thread = std::thread(&Renderer::threadMain, this);
+}
+
+void Renderer::Stop()
+{
+	if (!thread.joinable())
+		return;
+	running = false;
+	snapshots.Interrupt();
+	thread.join();
+}
+
+const std::vector<ModelNode> &Renderer::ModelNodes(RenderModel model)
+{
+	std::unique_lock<std::mutex> lock(loadMutex);
+	loadedSignal.wait(lock, [this] { return modelsLoaded; });
+	return modelNodes[model];
+}
+
+const std::vector<std::shared_ptr<const MeshBVH> > &Renderer::ModelCollision(RenderModel model)
+{
+	std::unique_lock<std::mutex> lock(loadMutex);
+	loadedSignal.wait(lock, [this] { return modelsLoaded; });
+	return modelCollision[model];
+}
+
+void Renderer::threadMain()
+{
+	glfwMakeContextCurrent(window);
+	//vsync where the driver supports it, the game thread's pacer caps the frame rate where it doesn't
+	glfwSwapInterval(settings.vsync ? 1 : 0);
+
+	init();
+
+	while (running) {
+		//sleep until the game publishes a new frame, the idle menu publishes nothing so we just sit here
+		if (!snapshots.Acquire()) {
+			snapshots.WaitForNew(SNAPSHOT_WAIT_TIMEOUT);
+			continue;
+		}
+
+		const RenderSnapshot &snapshot = snapshots.ReadBuffer();
+		render(snapshot);
+		glfwSwapBuffers(window);
+
+		if (snapshot.inputTime >= 0.0) {
+			double ms = (glfwGetTime() - snapshot.inputTime) * 1000.0;
+			double average = inputLatencyMs.load();
+			//exponential moving average so the title shows something readable
+			inputLatencyMs = average < 0.0 ? ms : average + (ms - average) * 0.1;
+		}
+		framesPresented++;
+	}
+
+	shutdown();
+	glfwMakeContextCurrent(NULL);
+}
+
+void Renderer::init()
+{
+	//set z depth buffering on
+	glEnable(GL_DEPTH_TEST);
+
+	//load images in, flip them
+	stbi_set_flip_vertically_on_load(true);
+
+	shaderProgram1 = new Shader("vertexShader1.txt", "fragmentShader1.txt");
+	lightShader = new Shader("modelShader.vs", "modelShader.fs");
+
+	models[RENDER_MODEL_EGG] = new Model("assets/Egg/YoshiEgg.obj");
+	models[RENDER_MODEL_YOSHI] = new Model("assets/Yoshi/Yoshi.obj");
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		for (int i = 0; i < RENDER_MODEL_COUNT; i++) {
+			modelNodes[i] = models[i]->nodes;
+			for (size_t m = 0; m < models[i]->meshes.size(); m++)
+				modelCollision[i].push_back(models[i]->meshes[m].bvh);
+		}
+		modelsLoaded = true;
+	}
+	loadedSignal.notify_all();
+
+	//camera uniforms for every view, std140 lays ViewData out as view, projection, viewPos back to back.
+	//glBindBufferRange offsets must be a multiple of the driver's alignment, so each slot is padded up to it
+	int uboAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+	unsigned int viewDataSize = 2 * sizeof(glm::mat4) + sizeof(glm::vec4);
+	viewStride = uboAlignment > 0 ? (viewDataSize + uboAlignment - 1) / uboAlignment * uboAlignment : viewDataSize;
+	glGenBuffers(1, &viewUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, viewUBO);
+	glBufferData(GL_UNIFORM_BUFFER, viewStride * MAX_VIEWS, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	//the scene shaders read their camera from binding point 0
+	glUniformBlockBinding(lightShader->ID, glGetUniformBlockIndex(lightShader->ID, "ViewData"), 0);
+
+	floor.Init();
+
+	dynamicResolution.Init();
+	dynamicResolution.Configure(settings.dynamicResolution, settings.minResolutionScale, settings.maxResolutionScale, settings.frameTimeBudget);
+
+	float textureRectVertices[] = {
+		// positions // colors // texture coords
+		1, 1, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // top right
+		1, -1, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // bottom right
+		-1, -1, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // bottom left
+		-1, 1, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f // top left 
+	};
+
+	unsigned int textureRectIndices[] = {
+		0, 1, 3, //first triangle 
+		1, 2, 3 //seconds triangle
+	};
+
+
+	//menu vbo/vao and binding
+	glGenBuffers(1, &textureRectVBO);
+	
+	glGenBuffers(1, &textureRectEBO);
+
+	glGenVertexArrays(1, &textureRectVAO);
+	//to work with this VAO bind it to make it the current one
+	glBindVertexArray(textureRectVAO);
+
+		//bind vbo
+		glBindBuffer(GL_ARRAY_BUFFER, textureRectVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(textureRectVertices), textureRectVertices, GL_STATIC_DRAW);
+
+		//bind ebo
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, textureRectEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(textureRectIndices), textureRectIndices, GL_STATIC_DRAW);
+
+		//position (x, y, z)
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+
+		//colour (r, g, b)
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		//Texture Coordinate(S,T)
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+
+	//unbind VAO
+	glBindVertexArray(0);
+
+	glGenTextures(1, &texture1ID);
+	glBindTexture(GL_TEXTURE_2D, texture1ID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//wrap on the s(x) axis
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//wraps on the t(y) axis
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);//GL_LINEAR(bilinear) or GL_NEAREST for shrinking
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);//for stretching
+
+	//load up jpg file
+
+	//menu
+	int width, height, numberChannels;
+	unsigned char* image1Data = stbi_load("menu.jpg", &width, &height, &numberChannels, 0);
+
+	if (image1Data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,  0, GL_RGB, GL_UNSIGNED_BYTE, image1Data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else cout << "image failed to load" << endl;
+	
+	stbi_image_free(image1Data);
+
+
+
+
+
+	//generate a texture in gpu, return id
+	glGenTextures(1, &groundTexture1ID);
+	//we bind the texture to make it the one we're working on
+	glBindTexture(GL_TEXTURE_2D, groundTexture1ID);
+	//set wrapping options(repeat texture if texture coordinates dont fully cover polygons)
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//wrap on the s(x) axis
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//wraps on the t(y) axis
+																 //set filtering options
+																 //Suggestion use nearest neighbour for pixel art, use bilinear for pretty much everything else
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);//GL_LINEAR(bilinear) or GL_NEAREST for shrinking
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);//for stretching
+
+																	 //LOAD UP IMAGE FILE (JPEG FIRST)
+	int cubeWidth, cubeHeight, cubeNumberChannels; //as we load an image, we'll get values from it to fill these in
+	unsigned char *ground1Data = stbi_load("assets/yoshiGround/yoshiGround.jpg", &cubeWidth, &cubeHeight, &cubeNumberChannels, 0);
+	//if it loaded
+	if (ground1Data) {
+		cout << "Success! Image is " << cubeWidth << " by " << cubeHeight << "pixels" << endl;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cubeWidth, cubeHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, ground1Data);
+
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		cout << "Image load failed!" << endl;
+	}
+	//cleanup image memory
+	stbi_image_free(ground1Data);
+
+	//Generate a texture in our graphics card to work with
+	glGenTextures(1, &groundTexture2ID); //generate 1 texture id and store in texture2ID
+	glBindTexture(GL_TEXTURE_2D, groundTexture2ID);//make this texture the currently working texture, sayings its a 2d texture (as opposed to 1d and 3d)
+											 //how will texture repeat on large surfaces
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);//how wrap horizontally (S axis...)
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//how to wrap vertically (T axis..)
+																 //how will texture deal with shrink and stretch
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); //when shrinking texture use bilinear filter
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);//use nearest neighbour filtering on stretch
+
+																	  //Load up an image
+	unsigned char *groundData2 = stbi_load("assets/yoshiGround/yoshiGround.png", &cubeWidth, &cubeHeight, &cubeNumberChannels, 0);
+	if (groundData2) {
+		//give the texture in our graphics card the data from this png file
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cubeWidth, cubeHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, groundData2);
+		//generate mipmaps for this texture
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		cout << "failed to load score" << endl;
+	}
+	//free image data from ram because theres a copy in the texture
+	stbi_image_free(groundData2);
+
+}
+
+void Renderer::render(const RenderSnapshot &snapshot)
+{
+	if (snapshot.width != viewportWidth || snapshot.height != viewportHeight) {
+		viewportWidth = snapshot.width;
+		viewportHeight = snapshot.height;
+		glViewport(0, 0, viewportWidth, viewportHeight);
+	}
+
+	if (snapshot.menu) {
+		glClearColor(0, 0, 1, 1); //blue
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //clear screen with clear colour
+
+		//menu screen, always at native resolution
+		shaderProgram1->use();
+		int texture1Uniform = glGetUniformLocation(shaderProgram1->ID, "texture1");
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1ID);
+		glUniform1i(texture1Uniform, 0);
+		glBindVertexArray(textureRectVAO);
+
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		return;
+	}
+
+	//frustum culling: a world space bounding sphere for every mesh of every draw item, built once and tested
+	//against every view's frustum in one SIMD pass
+	cullSpheres.Clear();
+	for (size_t i = 0; i < snapshot.draws.size(); i++) {
+		const DrawItem &item = snapshot.draws[i];
+		const vector<Mesh> &meshes = models[item.model]->meshes;
+		const vector<unsigned int> &nodeMeshes = models[item.model]->nodes[item.node].meshes;
+		for (size_t m = 0; m < nodeMeshes.size(); m++) {
+			const Mesh &mesh = meshes[nodeMeshes[m]];
+			glm::vec3 center;
+			float radius;
+			TransformSphere(item.transform, mesh.sphereCenter, mesh.sphereRadius, center, radius);
+			cullSpheres.Add(center, radius);
+		}
+	}
+	unsigned int viewCount = snapshot.viewCount;
+	Frustum frusta[MAX_VIEWS];
+	for (unsigned int v = 0; v < viewCount; v++)
+		frusta[v] = snapshot.views[v].frustum;
+	unsigned int visible = CullSpheresViews(frusta, viewCount, cullSpheres);
+	meshesCulled = (unsigned int)cullSpheres.Size() * viewCount - visible;
+	unsigned int occluded = 0;
+	if (settings.occlusionCulling) {
+		for (unsigned int v = 0; v < viewCount; v++)
+			occluded += cullOccluded(snapshot, v);
+	}
+	meshesOccluded = occluded;
+	meshesVisible = visible - occluded;
+
+	//the floor only costs the chunks some view can see
+	floor.Update(snapshot.floor);
+	floor.Cull(snapshot.floor, frusta, viewCount);
+
+	uploadViews(snapshot);
+
+	//the 3D scene goes into the dynamic resolution target and gets stretched over the window at the end
+	dynamicResolution.BeginScene(viewportWidth, viewportHeight);
+
+	glClearColor(0, 0, 1, 1); //blue
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //clear screen with clear colour
+
+	//state shared by every view is set once
+	lightShader->use();
+	lightShader->setVec3("objectColor", 1.0f, 0.5f, 1.0f);
+	lightShader->setVec3("lightColor", snapshot.lightColour);
+	lightShader->setVec3("lightPos", snapshot.lightPos);
+
+	int sceneWidth = dynamicResolution.SceneWidth();
+	int sceneHeight = dynamicResolution.SceneHeight();
+	for (unsigned int v = 0; v < viewCount; v++) {
+		const RenderView &view = snapshot.views[v];
+		glViewport((int)(view.viewport.x * sceneWidth), (int)(view.viewport.y * sceneHeight),
+			(int)(view.viewport.z * sceneWidth), (int)(view.viewport.w * sceneHeight));
+		glBindBufferRange(GL_UNIFORM_BUFFER, 0, viewUBO, v * viewStride, 2 * sizeof(glm::mat4) + sizeof(glm::vec4));
+
+		floor.Draw(snapshot.floor, v, groundTexture1ID, groundTexture2ID);
+
+		//model stuff
+		lightShader->use();
+
+		//same order as the spheres were added in
+		unsigned char viewBit = (unsigned char)(1 << v);
+		size_t sphere = 0;
+		for (size_t i = 0; i < snapshot.draws.size(); i++) {
+			const DrawItem &item = snapshot.draws[i];
+			vector<Mesh> &meshes = models[item.model]->meshes;
+			const vector<unsigned int> &nodeMeshes = models[item.model]->nodes[item.node].meshes;
+			bool transformSet = false;
+			for (size_t m = 0; m < nodeMeshes.size(); m++) {
+				if (!(cullSpheres.visible[sphere++] & viewBit))
+					continue;
+				if (!transformSet) {
+					lightShader->setMat4("model", item.transform);
+					transformSet = true;
+				}
+				meshes[nodeMeshes[m]].Draw(*lightShader);
+			}
+		}
+	}
+
+	dynamicResolution.EndScene();
+}
+
+//writes the camera of every view whose version changed since its slot was last filled. a different view count
+//means a different layout, so every slot gets rewritten then
+void Renderer::uploadViews(const RenderSnapshot &snapshot)
+{
+	if (snapshot.viewCount != uploadedViewCount) {
+		for (unsigned int v = 0; v < MAX_VIEWS; v++)
+			viewUploaded[v] = false;
+		uploadedViewCount = snapshot.viewCount;
+	}
+
+	bool bound = false;
+	for (unsigned int v = 0; v < snapshot.viewCount; v++) {
+		const RenderView &view = snapshot.views[v];
+		if (viewUploaded[v] && view.cameraVersion == uploadedCameraVersion[v])
+			continue;
+		if (!bound) {
+			glBindBuffer(GL_UNIFORM_BUFFER, viewUBO);
+			bound = true;
+		}
+		glm::vec4 viewPos(view.viewPos, 1.0f);
+		glBufferSubData(GL_UNIFORM_BUFFER, v * viewStride, sizeof(glm::mat4), glm::value_ptr(view.view));
+		glBufferSubData(GL_UNIFORM_BUFFER, v * viewStride + sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view.projection));
+		glBufferSubData(GL_UNIFORM_BUFFER, v * viewStride + 2 * sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(viewPos));
+		viewUploaded[v] = true;
+		uploadedCameraVersion[v] = view.cameraVersion;
+	}
+	if (bound)
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//rasterises the snapshot's occluders on the CPU from one view and clears that view's bit of every mesh whose box
+//is hidden behind them, returns how many that was
+unsigned int Renderer::cullOccluded(const RenderSnapshot &snapshot, unsigned int view)
+{
+	if (snapshot.occluders.empty())
+		return 0;
+
+	occlusion.Clear(snapshot.views[view].projection * snapshot.views[view].view);
+	for (size_t i = 0; i < snapshot.occluders.size(); i++) {
+		const Occluder &occluder = snapshot.occluders[i];
+		occlusion.RasterizeBox(occluder.transform, occluder.boundsMin, occluder.boundsMax);
+	}
+	occlusion.Finish();
+
+	//same order the spheres were added in
+	unsigned char viewBit = (unsigned char)(1 << view);
+	unsigned int occluded = 0;
+	size_t sphere = 0;
+	for (size_t i = 0; i < snapshot.draws.size(); i++) {
+		const DrawItem &item = snapshot.draws[i];
+		const vector<Mesh> &meshes = models[item.model]->meshes;
+		const vector<unsigned int> &nodeMeshes = models[item.model]->nodes[item.node].meshes;
+		for (size_t m = 0; m < nodeMeshes.size(); m++, sphere++) {
+			if (!(cullSpheres.visible[sphere] & viewBit))
+				continue;
+			const Mesh &mesh = meshes[nodeMeshes[m]];
+			if (!occlusion.TestBox(item.transform, mesh.boundsMin, mesh.boundsMax)) {
+				cullSpheres.visible[sphere] &= (unsigned char)~viewBit;
+				occluded++;
+			}
+		}
+	}
+	return occluded;
+}
+
+void Renderer::shutdown()
+{
+	floor.Shutdown();
+	dynamicResolution.Shutdown();
+
+	//optional: de-allocate all resources
+	glDeleteVertexArrays(1, &textureRectVAO);//params: how many, thing with ids(unsigned int, or array of)
+	glDeleteBuffers(1, &textureRectVBO);
+	glDeleteBuffers(1, &textureRectEBO);
+	glDeleteBuffers(1, &viewUBO);
+
+	delete shaderProgram1;
+	delete lightShader;
+	for (int i = 0; i < RENDER_MODEL_COUNT; i++) {
+		delete models[i];
+		models[i] = NULL;
+	}
+}
+
+unsigned int loadTexture(char const * path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data)
+	{
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		stbi_image_free(data);
+	}
+	else
+	{
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+		stbi_image_free(data);
+	}
+
+	return textureID;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DynamicResolution.h"
+#include "FloorRenderer.h"
+#include "Frustum.h"
+#include "MeshBVH.h"
+#include "OcclusionBuffer.h"
+#include "RenderSnapshot.h"
+#include "SceneGraph.h"
+#include "TripleBuffer.h"
+
+class Shader;
+class Model;
+
+// how the render thread should run, handed over once in Start
+struct RenderSettings {
+	bool vsync;
+
+	// dynamic resolution: the 3D scene renders somewhere between these fractions of the window size,
+	// whatever keeps the GPU time of a frame inside the budget. the menu always draws at full size
+	bool dynamicResolution;
+	float minResolutionScale;
+	float maxResolutionScale;
+	double frameTimeBudget; // seconds
+
+	// test meshes against a small CPU depth buffer of the snapshot's occluders before drawing them
+	bool occlusionCulling;
+
+	RenderSettings() : vsync(true), dynamicResolution(true), minResolutionScale(0.5f), maxResolutionScale(1.0f), frameTimeBudget(1.0 / 60.0),
+		occlusionCulling(true) {}
+};
+
+// Owns the OpenGL context and everything living in it. Start hands the window's context over to a
+// dedicated render thread, which loads the shaders/models/textures and then draws each RenderSnapshot
+// the game thread publishes, so building frame N+1 overlaps with submitting frame N.
+class Renderer
+{
+public:
+	Renderer();
+	~Renderer();
+
+	// the window's context must not be current on the calling thread any more
+	void Start(GLFWwindow* window, const RenderSettings &settings);
+	// finishes the frame in flight, frees the GL resources and joins the render thread
+	void Stop();
+
+	// game thread: fill in the snapshot returned by BeginSnapshot completely, then publish it
+	RenderSnapshot &BeginSnapshot() { return snapshots.WriteBuffer(); }
+	void PublishSnapshot() { snapshots.Publish(); }
+
+	// game thread: a model's node hierarchy, for attaching it to the scene graph. models load on the render
+	// thread, so the first call waits for that to finish
+	const std::vector<ModelNode> &ModelNodes(RenderModel model);
+	// game thread: each of a model's meshes' BVH, indexed like the mesh indices in ModelNodes
+	const std::vector<std::shared_ptr<const MeshBVH> > &ModelCollision(RenderModel model);
+
+	// stats for the window title, safe to read from the game thread
+	unsigned int FramesPresented() const { return framesPresented.load(); }
+	double InputLatencyMs() const { return inputLatencyMs.load(); }
+	// meshes that were drawn / failed frustum culling / were hidden behind occluders in the last drawn frame,
+	// summed over all its views
+	unsigned int MeshesVisible() const { return meshesVisible.load(); }
+	unsigned int MeshesCulled() const { return meshesCulled.load(); }
+	unsigned int MeshesOccluded() const { return meshesOccluded.load(); }
+
+private:
+	GLFWwindow* window;
+	RenderSettings settings;
+	std::thread thread;
+	std::atomic<bool> running;
+
+	TripleBuffer<RenderSnapshot> snapshots;
+
+	std::atomic<unsigned int> framesPresented;
+	std::atomic<double> inputLatencyMs;
+	std::atomic<unsigned int> meshesVisible;
+	std::atomic<unsigned int> meshesCulled;
+	std::atomic<unsigned int> meshesOccluded;
+
+	// GL resources, only ever touched on the render thread
+	Shader* shaderProgram1;
+	Shader* lightShader;
+	Model* models[RENDER_MODEL_COUNT];
+
+	// copies of the models' node hierarchies (and the meshes' BVHs) handed to the game thread once loading is done
+	std::vector<ModelNode> modelNodes[RENDER_MODEL_COUNT];
+	std::vector<std::shared_ptr<const MeshBVH> > modelCollision[RENDER_MODEL_COUNT];
+	bool modelsLoaded;
+	std::mutex loadMutex;
+	std::condition_variable loadedSignal;
+
+	unsigned int textureRectVAO, textureRectVBO, textureRectEBO;
+	unsigned int texture1ID;
+	unsigned int groundTexture1ID, groundTexture2ID;
+
+	int viewportWidth, viewportHeight;
+
+	// one uniform buffer holds every view's camera, each shader reads it as the ViewData block and the slot of
+	// the view being drawn gets bound with glBindBufferRange. a slot is only rewritten when its camera version
+	// differs from the one already in it
+	unsigned int viewUBO;
+	unsigned int viewStride; // bytes per slot, rounded up to the driver's offset alignment
+	bool viewUploaded[MAX_VIEWS];
+	unsigned int uploadedCameraVersion[MAX_VIEWS];
+	unsigned int uploadedViewCount;
+
+	DynamicResolution dynamicResolution;
+	FloorRenderer floor;
+	SphereSet cullSpheres; // one per mesh of every draw item, rebuilt each frame
+	OcclusionBuffer occlusion;
+
+	void threadMain();
+	void init();
+	void render(const RenderSnapshot &snapshot);
+	void uploadViews(const RenderSnapshot &snapshot);
+	unsigned int cullOccluded(const RenderSnapshot &snapshot, unsigned int view);
+	void shutdown();
+};
@@ -0,0 +1,209 @@
+#include "SceneGraph.h"
+
+const unsigned int SceneGraph::INVALID;
+
+SceneGraph::SceneGraph() : firstDirty(INVALID), lastUpdated(0)
+{
+}
+
+unsigned int SceneGraph::add(int parentIndex, const glm::mat4 &transform, int model, int node)
+{
+	//appending always keeps the order valid, the parent already exists so it is somewhere before us
+	unsigned int index = (unsigned int)parent.size();
+	SceneNode id;
+	if (!freeHandles.empty()) {
+		id = freeHandles.back();
+		freeHandles.pop_back();
+		indexOf[id] = index;
+	}
+	else {
+		id = (SceneNode)indexOf.size();
+		indexOf.push_back(index);
+	}
+
+	parent.push_back(parentIndex);
+	local.push_back(transform);
+	world.push_back(transform);
+	dirty.push_back(0);
+	renderModel.push_back(model);
+	modelNode.push_back(node);
+	handle.push_back(id);
+	markDirty(index);
+	return index;
+}
+
+void SceneGraph::markDirty(unsigned int index)
+{
+	dirty[index] = 1;
+	if (firstDirty == INVALID || index < firstDirty)
+		firstDirty = index;
+}
+
+SceneNode SceneGraph::Create(SceneNode parentNode, const glm::mat4 &transform)
+{
+	int parentIndex = IsValid(parentNode) ? (int)indexOf[parentNode] : -1;
+	return handle[add(parentIndex, transform, -1, -1)];
+}
+
+SceneNode SceneGraph::AttachModel(const std::vector<ModelNode> &modelNodes, int model, SceneNode parentNode)
+{
+	int parentIndex = IsValid(parentNode) ? (int)indexOf[parentNode] : -1;
+	if (modelNodes.empty())
+		return handle[add(parentIndex, glm::mat4(1.0f), -1, -1)];
+
+	//model nodes are already parent first, so they can go in as they are, just offset
+	unsigned int base = (unsigned int)parent.size();
+	for (size_t i = 0; i < modelNodes.size(); i++) {
+		const ModelNode &node = modelNodes[i];
+		int nodeParent = node.parent < 0 ? parentIndex : (int)base + node.parent;
+		bool drawn = !node.meshes.empty();
+		add(nodeParent, node.transform, drawn ? model : -1, drawn ? (int)i : -1);
+	}
+	return handle[base];
+}
+
+void SceneGraph::Remove(SceneNode node)
+{
+	if (!IsValid(node))
+		return;
+
+	//everything from the node onwards whose parent is going goes too, then squash the gaps out
+	unsigned int first = indexOf[node];
+	unsigned int count = (unsigned int)parent.size();
+	std::vector<unsigned char> removed(count, 0);
+	removed[first] = 1;
+	for (unsigned int i = first + 1; i < count; i++) {
+		if (parent[i] >= (int)first && removed[parent[i]])
+			removed[i] = 1;
+	}
+
+	std::vector<unsigned int> order;
+	order.reserve(count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (removed[i]) {
+			indexOf[handle[i]] = INVALID;
+			freeHandles.push_back(handle[i]);
+		}
+		else
+			order.push_back(i);
+	}
+	reorder(order);
+}
+
+void SceneGraph::SetParent(SceneNode node, SceneNode parentNode)
+{
+	if (!IsValid(node))
+		return;
+	unsigned int index = indexOf[node];
+	int parentIndex = IsValid(parentNode) ? (int)indexOf[parentNode] : -1;
+
+	//refuse to make a node its own ancestor
+	for (int p = parentIndex; p >= 0; p = parent[p]) {
+		if (p == (int)index)
+			return;
+	}
+
+	parent[index] = parentIndex;
+	markDirty(index);
+	//a parent further down the array than its new child breaks the ordering, rebuild it
+	if (parentIndex > (int)index)
+		sortTopologically();
+}
+
+void SceneGraph::SetLocal(SceneNode node, const glm::mat4 &transform)
+{
+	unsigned int index = indexOf[node];
+	//things that didn't move don't cost their subtree an update
+	if (local[index] == transform)
+		return;
+	local[index] = transform;
+	markDirty(index);
+}
+
+void SceneGraph::Update()
+{
+	lastUpdated = 0;
+	if (firstDirty == INVALID)
+		return;
+
+	//parents come first, so by the time we reach a node its parent's world transform and dirty flag are final
+	unsigned int count = (unsigned int)parent.size();
+	for (unsigned int i = firstDirty; i < count; i++) {
+		int p = parent[i];
+		if (p >= 0 && dirty[p])
+			dirty[i] = 1;
+		if (!dirty[i])
+			continue;
+		world[i] = p >= 0 ? world[p] * local[i] : local[i];
+		lastUpdated++;
+	}
+	for (unsigned int i = firstDirty; i < count; i++)
+		dirty[i] = 0;
+	firstDirty = INVALID;
+}
+
+//keeps the nodes listed in order (old indices) in that order and drops the rest
+void SceneGraph::reorder(const std::vector<unsigned int> &order)
+{
+	unsigned int count = (unsigned int)parent.size();
+	std::vector<unsigned int> newIndex(count, INVALID);
+	for (unsigned int i = 0; i < order.size(); i++)
+		newIndex[order[i]] = i;
+
+	std::vector<int> newParent(order.size());
+	std::vector<glm::mat4> newLocal(order.size()), newWorld(order.size());
+	std::vector<unsigned char> newDirty(order.size());
+	std::vector<int> newModel(order.size()), newModelNode(order.size());
+	std::vector<SceneNode> newHandle(order.size());
+	firstDirty = INVALID;
+	for (unsigned int i = 0; i < order.size(); i++) {
+		unsigned int old = order[i];
+		newParent[i] = parent[old] >= 0 ? (int)newIndex[parent[old]] : -1;
+		newLocal[i] = local[old];
+		newWorld[i] = world[old];
+		newDirty[i] = dirty[old];
+		newModel[i] = renderModel[old];
+		newModelNode[i] = modelNode[old];
+		newHandle[i] = handle[old];
+		indexOf[handle[old]] = i;
+		if (newDirty[i] && firstDirty == INVALID)
+			firstDirty = i;
+	}
+
+	parent.swap(newParent);
+	local.swap(newLocal);
+	world.swap(newWorld);
+	dirty.swap(newDirty);
+	renderModel.swap(newModel);
+	modelNode.swap(newModelNode);
+	handle.swap(newHandle);
+}
+
+//puts every parent back in front of its children, keeping siblings in their current order
+void SceneGraph::sortTopologically()
+{
+	unsigned int count = (unsigned int)parent.size();
+
+	//children grouped by parent (counting sort), roots live in the extra last bucket
+	std::vector<unsigned int> start(count + 2, 0);
+	for (unsigned int i = 0; i < count; i++)
+		start[(parent[i] >= 0 ? parent[i] : count) + 1]++;
+	for (unsigned int i = 1; i < count + 2; i++)
+		start[i] += start[i - 1];
+	std::vector<unsigned int> children(count);
+	std::vector<unsigned int> fill(start.begin(), start.end() - 1);
+	for (unsigned int i = 0; i < count; i++)
+		children[fill[parent[i] >= 0 ? parent[i] : count]++] = i;
+
+	//breadth first from the roots, every node is emitted after its parent
+	std::vector<unsigned int> order;
+	order.reserve(count);
+	for (unsigned int c = start[count]; c < start[count + 1]; c++)
+		order.push_back(children[c]);
+	for (size_t i = 0; i < order.size(); i++) {
+		unsigned int node = order[i];
+		for (unsigned int c = start[node]; c < start[node + 1]; c++)
+			order.push_back(children[c]);
+	}
+	reorder(order);
+}
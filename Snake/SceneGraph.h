@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// One node of a model file's hierarchy as assimp describes it. Parents always come before their children
+// in a model's node list, the root is node 0.
+struct ModelNode {
+	std::string name;
+	int parent; // -1 for the root
+	glm::mat4 transform; // relative to the parent
+	std::vector<unsigned int> meshes; // indices into the model's meshes
+};
+
+typedef unsigned int SceneNode;
+const SceneNode NO_SCENE_NODE = 0xFFFFFFFF;
+
+// Node hierarchy for everything in the world. Nodes are kept in one flat array sorted so every parent comes
+// before its children, which lets a single forward pass compute world transforms. Changing a node's local
+// transform only marks it dirty; Update then starts at the first dirty node and recomputes just the dirty
+// subtrees. SceneNode handles stay valid while other nodes are added, removed or reparented.
+class SceneGraph
+{
+public:
+	SceneGraph();
+
+	SceneNode Create(SceneNode parent = NO_SCENE_NODE, const glm::mat4 &local = glm::mat4(1.0f));
+	// copies a model's node hierarchy in below parent, returns the node standing in for the model's root
+	SceneNode AttachModel(const std::vector<ModelNode> &modelNodes, int renderModel, SceneNode parent = NO_SCENE_NODE);
+	// removes node along with everything below it
+	void Remove(SceneNode node);
+	// moves node (and its subtree) under a new parent, its local transform is kept
+	void SetParent(SceneNode node, SceneNode parent);
+
+	void SetLocal(SceneNode node, const glm::mat4 &local);
+	const glm::mat4 &GetLocal(SceneNode node) const { return local[indexOf[node]]; }
+	// as of the last Update
+	const glm::mat4 &GetWorld(SceneNode node) const { return world[indexOf[node]]; }
+	bool IsValid(SceneNode node) const { return node < indexOf.size() && indexOf[node] != INVALID; }
+
+	void Update();
+	// world transforms recomputed by the last Update
+	unsigned int LastUpdated() const { return lastUpdated; }
+
+	// nodes in hierarchy order, for walking the whole scene (e.g. to collect draws)
+	size_t Size() const { return parent.size(); }
+	int RenderModelAt(size_t index) const { return renderModel[index]; }
+	int ModelNodeAt(size_t index) const { return modelNode[index]; }
+	const glm::mat4 &WorldAt(size_t index) const { return world[index]; }
+
+private:
+	static const unsigned int INVALID = 0xFFFFFFFF;
+
+	// dense, hierarchy sorted arrays
+	std::vector<int> parent;
+	std::vector<glm::mat4> local;
+	std::vector<glm::mat4> world;
+	std::vector<unsigned char> dirty;
+	std::vector<int> renderModel; // -1 when there's nothing to draw at this node
+	std::vector<int> modelNode;
+	std::vector<SceneNode> handle;
+
+	// handle -> dense index
+	std::vector<unsigned int> indexOf;
+	std::vector<SceneNode> freeHandles;
+
+	unsigned int firstDirty; // nothing before this needs updating, INVALID when nothing does
+	unsigned int lastUpdated;
+
+	unsigned int add(int parentIndex, const glm::mat4 &transform, int model, int node);
+	void markDirty(unsigned int index);
+	void reorder(const std::vector<unsigned int> &order);
+	void sortTopologically();
+};
@@ -27,7 +27,7 @@ void processInputs(GLFWwindow* window) {
 }
 */
 
-void showFPS(GLFWwindow* window) {
+void showFPS(GLFWwindow* window, double inputLatencyMs, int frames, const string &extra) {
 	//static function variables are declared 
 	//once per project run, so these 2 lines of 
 	//code run once and then the variables persist
@@ -47,10 +47,13 @@ void showFPS(GLFWwindow* window) {
 		stringstream ss;
 		ss.precision(3);//3 decimal places
 		ss << fixed << "Yoshi Snake FPS: " << fps << " Frame Time: " << msPerFrame << "(ms)";
+		if (inputLatencyMs >= 0.0)
+			ss << " Input Latency: " << inputLatencyMs << "(ms)";
+		ss << extra;
 
 		glfwSetWindowTitle(window, ss.str().c_str());
 		frameCount = 0;
 	}
-	frameCount++;
+	frameCount += frames;
 }
 
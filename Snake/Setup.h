@@ -14,5 +14,6 @@ void windowResizeCallBack(GLFWwindow* window, int width, int height);
 //user inputs
 //void processInputs(GLFWwindow* window);
 
-//Frames Per Second prototype
-void showFPS(GLFWwindow* window);
+//Frames Per Second prototype, counts 'frames' more frames and also shows input latency when one is given
+//and any extra text (render stats) after that
+void showFPS(GLFWwindow* window, double inputLatencyMs = -1.0, int frames = 1, const string &extra = "");
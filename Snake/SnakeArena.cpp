@@ -0,0 +1,392 @@
+#include "SnakeArena.h"
+
+#include <climits>
+#include <cstdlib>
+
+//random cells tried for an egg or a respawn before giving up until the next tick
+const int ARENA_PLACE_TRIES = 16;
+//eggs a bot looks at when picking a new one to chase, it goes for the closest
+const int BOT_EGG_SAMPLES = 4;
+
+static const int STEP_X[4] = { 0, 1, 0, -1 };
+static const int STEP_Z[4] = { -1, 0, 1, 0 };
+
+const unsigned int SnakeArena::SNAKES_PER_JOB;
+const int SnakeArena::MIN_RING_SHIFT;
+const int SnakeArena::RING_CLASSES;
+
+SnakeArena::SnakeArena(int width, int height, uint64_t seed, int threads) : width(0), height(0), rng(seed),
+	eggTarget(0), growthPerEgg(1), startLength(4), respawnBots(true), aliveCount(0), ticks(0), jobs(JobSystem::WorkersFor(threads))
+{
+	grid.Resize(width, height);
+	this->width = grid.Width();
+	this->height = grid.Height();
+	claimed.Resize(this->width, this->height);
+	contested.Resize(this->width, this->height);
+	leaving.Resize(this->width, this->height);
+}
+
+void SnakeArena::SetEggTarget(int eggs)
+{
+	eggTarget = eggs;
+	topUpEggs();
+}
+
+int SnakeArena::Spawn(int x, int z, SnakeDirection direction, SnakeControl control)
+{
+	if (!fits(x, z, direction))
+		return -1;
+	int snake = addSnake(control);
+	place(snake, x, z, direction);
+	return snake;
+}
+
+int SnakeArena::SpawnAnywhere(SnakeControl control)
+{
+	int snake = addSnake(control);
+	if (placeAnywhere(snake))
+		return snake;
+	//nowhere to put it, forget it again
+	alive.pop_back();
+	this->control.pop_back();
+	direction.pop_back();
+	nextDirection.pop_back();
+	result.pop_back();
+	headX.pop_back();
+	headZ.pop_back();
+	length.pop_back();
+	pendingGrowth.pop_back();
+	score.pop_back();
+	ringStart.pop_back();
+	ringMask.pop_back();
+	headSlot.pop_back();
+	targetEgg.pop_back();
+	botRng.pop_back();
+	moveTo.pop_back();
+	return -1;
+}
+
+void SnakeArena::Turn(int snake, SnakeDirection direction)
+{
+	if (((direction + 2) & 3) != this->direction[snake])
+		nextDirection[snake] = (unsigned char)direction;
+}
+
+int SnakeArena::addSnake(SnakeControl control)
+{
+	int snake = Snakes();
+	alive.push_back(0);
+	this->control.push_back((unsigned char)control);
+	direction.push_back(SNAKE_UP);
+	nextDirection.push_back(SNAKE_UP);
+	result.push_back(SNAKE_ARENA_DEAD);
+	headX.push_back(0);
+	headZ.push_back(0);
+	length.push_back(0);
+	pendingGrowth.push_back(0);
+	score.push_back(0);
+	ringStart.push_back(0);
+	ringMask.push_back(0);
+	headSlot.push_back(0);
+	targetEgg.push_back(-1);
+	botRng.push_back(rng.Split());
+	moveTo.push_back(-1);
+	return snake;
+}
+
+//every cell of the body on the arena and free, eggs included so nobody spawns on one
+bool SnakeArena::fits(int x, int z, SnakeDirection direction) const
+{
+	for (int i = 0; i < startLength; i++) {
+		int cellX = x - STEP_X[direction] * i, cellZ = z - STEP_Z[direction] * i;
+		if (!grid.Inside(cellX, cellZ) || grid.Occupied(cellX, cellZ) || grid.HasEgg(cellX, cellZ))
+			return false;
+	}
+	return true;
+}
+
+//laid out tail first so the head ends up in the newest slot, like SnakeSim::Reset
+void SnakeArena::place(int snake, int x, int z, SnakeDirection direction)
+{
+	int sizeClass = sizeClassOf(startLength);
+	ringStart[snake] = allocateRing(sizeClass);
+	ringMask[snake] = (1 << (MIN_RING_SHIFT + sizeClass)) - 1;
+	headSlot[snake] = ringMask[snake];
+	for (int i = startLength - 1; i >= 0; i--) {
+		int cellX = x - STEP_X[direction] * i, cellZ = z - STEP_Z[direction] * i;
+		headSlot[snake] = (headSlot[snake] + 1) & ringMask[snake];
+		segments[ringStart[snake] + headSlot[snake]] = cellZ * width + cellX;
+		grid.Occupy(cellX, cellZ);
+	}
+	length[snake] = startLength;
+	headX[snake] = x;
+	headZ[snake] = z;
+	this->direction[snake] = (unsigned char)direction;
+	nextDirection[snake] = (unsigned char)direction;
+	pendingGrowth[snake] = 0;
+	score[snake] = 0;
+	targetEgg[snake] = -1;
+	alive[snake] = 1;
+	aliveCount++;
+}
+
+bool SnakeArena::placeAnywhere(int snake)
+{
+	for (int i = 0; i < ARENA_PLACE_TRIES; i++) {
+		int x = (int)rng.Below(width), z = (int)rng.Below(height);
+		SnakeDirection direction = (SnakeDirection)rng.Below(4);
+		if (fits(x, z, direction)) {
+			place(snake, x, z, direction);
+			return true;
+		}
+	}
+	return false;
+}
+
+int SnakeArena::sizeClassOf(int size)
+{
+	int sizeClass = 0;
+	while ((1 << (MIN_RING_SHIFT + sizeClass)) < size)
+		sizeClass++;
+	return sizeClass;
+}
+
+//a free ring of the class if there is one, otherwise the pool grows by one at the end
+int SnakeArena::allocateRing(int sizeClass)
+{
+	std::vector<int> &free = freeRings[sizeClass];
+	if (!free.empty()) {
+		int start = free.back();
+		free.pop_back();
+		return start;
+	}
+	int start = (int)segments.size();
+	segments.resize(segments.size() + ((size_t)1 << (MIN_RING_SHIFT + sizeClass)));
+	return start;
+}
+
+void SnakeArena::freeRing(int snake)
+{
+	freeRings[sizeClassOf(ringMask[snake] + 1)].push_back(ringStart[snake]);
+}
+
+//a ring twice the size, tail first from slot 0 so the head is at length - 1
+void SnakeArena::growRing(int snake)
+{
+	int sizeClass = sizeClassOf(ringMask[snake] + 1) + 1;
+	int start = allocateRing(sizeClass);
+	int segmentCount = length[snake];
+	for (int i = 0; i < segmentCount; i++)
+		segments[start + i] = Segment(snake, segmentCount - 1 - i);
+	freeRing(snake);
+	ringStart[snake] = start;
+	ringMask[snake] = (1 << (MIN_RING_SHIFT + sizeClass)) - 1;
+	headSlot[snake] = segmentCount - 1;
+}
+
+//the free way closest to its egg, ways into a dead end only when there's nothing else. the egg is the closest of a
+//few picked at random whenever the last one is gone
+SnakeDirection SnakeArena::botDirection(int snake)
+{
+	int target = targetEgg[snake];
+	if (target < 0 || !grid.HasEgg(target % width, target / width)) {
+		target = -1;
+		int closest = INT_MAX;
+		for (int i = 0; i < BOT_EGG_SAMPLES && grid.EggCount() > 0; i++) {
+			int cell = grid.EggCell(botRng[snake].Below((uint32_t)grid.EggCount()));
+			int distance = abs(cell % width - headX[snake]) + abs(cell / width - headZ[snake]);
+			if (distance < closest) {
+				closest = distance;
+				target = cell;
+			}
+		}
+		targetEgg[snake] = target;
+	}
+
+	//straight on first, so a bot with nothing to chase keeps going
+	static const int TURNS[3] = { 0, 1, 3 };
+	int best = direction[snake], bestCost = INT_MAX;
+	for (int t = 0; t < 3; t++) {
+		int way = (direction[snake] + TURNS[t]) & 3;
+		int x = headX[snake] + STEP_X[way], z = headZ[snake] + STEP_Z[way];
+		if (!grid.Inside(x, z) || grid.Occupied(x, z))
+			continue;
+		int exits = 0;
+		for (int next = 0; next < 4; next++) {
+			int nextX = x + STEP_X[next], nextZ = z + STEP_Z[next];
+			exits += grid.Inside(nextX, nextZ) && !grid.Occupied(nextX, nextZ);
+		}
+		int cost = target >= 0 ? abs(target % width - x) + abs(target / width - z) : 0;
+		if (exits == 0)
+			cost += width + height;
+		if (cost < bestCost) {
+			bestCost = cost;
+			best = way;
+		}
+	}
+	return (SnakeDirection)best;
+}
+
+void SnakeArena::decide(int snake)
+{
+	if (!alive[snake])
+		return;
+	if (control[snake] == SNAKE_CONTROL_BOT)
+		nextDirection[snake] = (unsigned char)botDirection(snake);
+	int way = nextDirection[snake];
+	int x = headX[snake] + STEP_X[way], z = headZ[snake] + STEP_Z[way];
+	moveTo[snake] = grid.Inside(x, z) ? z * width + x : -1;
+}
+
+//only a tail that leaves this tick can be moved onto, and two heads on one cell kill each other
+void SnakeArena::resolve(int snake)
+{
+	if (!alive[snake]) {
+		result[snake] = SNAKE_ARENA_DEAD;
+		return;
+	}
+	int cell = moveTo[snake];
+	if (cell < 0) {
+		result[snake] = SNAKE_ARENA_HIT_WALL;
+		return;
+	}
+	int x = cell % width, z = cell / width;
+	if (grid.Occupied(x, z) && !leaving.Test(x, z))
+		result[snake] = SNAKE_ARENA_HIT_SNAKE;
+	else if (contested.Test(x, z))
+		result[snake] = SNAKE_ARENA_HEAD_ON;
+	else if (grid.HasEgg(x, z))
+		result[snake] = SNAKE_ARENA_ATE;
+	else
+		result[snake] = SNAKE_ARENA_MOVED;
+}
+
+void SnakeArena::kill(int snake)
+{
+	for (int i = 0; i < length[snake]; i++) {
+		int cell = Segment(snake, i);
+		grid.Vacate(cell % width, cell / width);
+	}
+	freeRing(snake);
+	length[snake] = 0;
+	alive[snake] = 0;
+	aliveCount--;
+}
+
+void SnakeArena::Tick()
+{
+	unsigned int snakes = (unsigned int)Snakes();
+	jobs.ParallelFor(0, snakes, SNAKES_PER_JOB, [&](unsigned int first, unsigned int last) {
+		for (unsigned int s = first; s < last; s++)
+			decide(s);
+	});
+
+	for (unsigned int s = 0; s < snakes; s++) {
+		if (!alive[s])
+			continue;
+		if (pendingGrowth[s] == 0) {
+			int cell = tail(s);
+			leaving.Set(cell % width, cell / width);
+		}
+		int cell = moveTo[s];
+		if (cell >= 0) {
+			if (claimed.Test(cell % width, cell / width))
+				contested.Set(cell % width, cell / width);
+			else
+				claimed.Set(cell % width, cell / width);
+		}
+	}
+
+	jobs.ParallelFor(0, snakes, SNAKES_PER_JOB, [&](unsigned int first, unsigned int last) {
+		for (unsigned int s = first; s < last; s++)
+			resolve(s);
+	});
+
+	//tails leave first so a head can follow one into its cell, a dying snake takes its whole body with it
+	for (unsigned int s = 0; s < snakes; s++) {
+		if (!alive[s])
+			continue;
+		int cell = moveTo[s];
+		if (cell >= 0) {
+			claimed.Reset(cell % width, cell / width);
+			contested.Reset(cell % width, cell / width);
+		}
+		if (pendingGrowth[s] == 0) {
+			cell = tail(s);
+			leaving.Reset(cell % width, cell / width);
+			if (result[s] <= SNAKE_ARENA_ATE)
+				grid.Vacate(cell % width, cell / width);
+		}
+	}
+	for (unsigned int s = 0; s < snakes; s++) {
+		if (alive[s] && result[s] > SNAKE_ARENA_ATE)
+			kill(s);
+	}
+	for (unsigned int s = 0; s < snakes; s++) {
+		if (!alive[s])
+			continue;
+		direction[s] = nextDirection[s];
+		if (pendingGrowth[s] > 0) {
+			pendingGrowth[s]--;
+			if (length[s] == ringMask[s] + 1)
+				growRing(s);
+			length[s]++;
+		}
+		int cell = moveTo[s];
+		headX[s] = cell % width;
+		headZ[s] = cell / width;
+		headSlot[s] = (headSlot[s] + 1) & ringMask[s];
+		segments[ringStart[s] + headSlot[s]] = cell;
+		grid.Occupy(headX[s], headZ[s]);
+		if (result[s] == SNAKE_ARENA_ATE) {
+			grid.RemoveEgg(headX[s], headZ[s]);
+			score[s]++;
+			pendingGrowth[s] += growthPerEgg;
+		}
+	}
+
+	if (respawnBots) {
+		for (unsigned int s = 0; s < snakes; s++) {
+			if (!alive[s] && control[s] == SNAKE_CONTROL_BOT)
+				placeAnywhere(s);
+		}
+	}
+	topUpEggs();
+	ticks++;
+}
+
+void SnakeArena::topUpEggs()
+{
+	while ((int)grid.EggCount() < eggTarget) {
+		bool placed = false;
+		for (int i = 0; i < ARENA_PLACE_TRIES && !placed; i++) {
+			int x = (int)rng.Below(width), z = (int)rng.Below(height);
+			placed = !grid.Occupied(x, z) && grid.AddEgg(x, z);
+		}
+		if (!placed)
+			return;
+	}
+}
+
+uint64_t SnakeArena::Checksum() const
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	auto mix = [&hash](uint64_t value) {
+		for (int i = 0; i < 8; i++) {
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= 0x100000001B3ull;
+		}
+	};
+	mix(ticks);
+	for (int s = 0; s < Snakes(); s++) {
+		mix(alive[s] | (uint64_t)direction[s] << 8 | (uint64_t)result[s] << 16);
+		mix((uint64_t)length[s] << 32 | (uint32_t)score[s]);
+		mix((uint64_t)headX[s] << 32 | (uint32_t)headZ[s]);
+		mix((uint64_t)pendingGrowth[s]);
+		for (int i = 0; i < length[s]; i++)
+			mix((uint64_t)Segment(s, i));
+	}
+	for (size_t i = 0; i < grid.EggCount(); i++)
+		mix((uint64_t)grid.EggCell(i));
+	return hash;
+}
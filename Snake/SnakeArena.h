@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ArenaGrid.h"
+#include "JobSystem.h"
+#include "SnakeSim.h"
+
+// who steers a snake in the arena: a player through Turn, or the arena's own egg chasing bot
+enum SnakeControl {
+	SNAKE_CONTROL_PLAYER,
+	SNAKE_CONTROL_BOT
+};
+
+// what happened to a snake on the last tick
+enum SnakeArenaResult {
+	SNAKE_ARENA_MOVED,
+	SNAKE_ARENA_ATE,
+	SNAKE_ARENA_HIT_WALL,
+	SNAKE_ARENA_HIT_SNAKE,	// its own body or anyone else's
+	SNAKE_ARENA_HEAD_ON,	// another head went for the same cell, both die
+	SNAKE_ARENA_DEAD		// wasn't alive this tick
+};
+
+// Thousands of snakes, players and bots, on one ArenaGrid. Per snake state is kept in arrays of its own, one
+// entry per snake, and every body is a power of two ring inside one shared pool of segments that's handed out in
+// size classes and reused when a snake dies or outgrows its ring.
+// A tick runs in phases:
+//  decide	 (parallel) bots pick a direction, every snake works out the cell its head goes to
+//  claim	 (serial)	 marks the cells heads go to, twice claimed ones, and tails that move out this tick
+//  resolve	 (parallel) walls, bodies and head-on collisions, against the grid as it was before the tick
+//  commit	 (serial)	 in snake order: tails leave, the dead are cleared away, heads move in, eggs and respawns
+// The parallel phases only read the shared state and write their own snake's entries, and everything shared
+// is written in snake order, so a tick gives the same result on any number of threads.
+// Like SnakeBatch an arena must be used from the thread that created it.
+class SnakeArena
+{
+public:
+	// threads in total ticking the arena, -1 is every hardware thread, 0 or 1 ticks everything on the calling thread
+	SnakeArena(int width, int height, uint64_t seed, int threads = -1);
+
+	// eggs kept on the arena, topped up straight away and at the end of every tick
+	void SetEggTarget(int eggs);
+	void SetGrowthPerEgg(int cells) { growthPerEgg = cells; }
+	// length of snakes spawned from now on
+	void SetStartLength(int cells) { startLength = cells < 1 ? 1 : cells; }
+	// dead bots come back somewhere free at the end of the tick they died in
+	void SetRespawnBots(bool respawn) { respawnBots = respawn; }
+
+	// a straight snake with its head at (x, z) facing direction, the rest trailing behind. -1 if it doesn't fit
+	int Spawn(int x, int z, SnakeDirection direction, SnakeControl control);
+	// the same somewhere random, -1 if no free spot turned up
+	int SpawnAnywhere(SnakeControl control);
+	// the direction a player snake takes next tick, turning straight back into the neck is ignored
+	void Turn(int snake, SnakeDirection direction);
+
+	void Tick();
+
+	unsigned int ThreadCount() const { return jobs.ThreadCount(); }
+	const ArenaGrid &Grid() const { return grid; }
+	unsigned long long Ticks() const { return ticks; }
+
+	int Snakes() const { return (int)alive.size(); }
+	int AliveCount() const { return aliveCount; }
+	bool Alive(int snake) const { return alive[snake] != 0; }
+	SnakeControl Control(int snake) const { return (SnakeControl)control[snake]; }
+	SnakeDirection Direction(int snake) const { return (SnakeDirection)direction[snake]; }
+	SnakeArenaResult Result(int snake) const { return (SnakeArenaResult)result[snake]; }
+	int Length(int snake) const { return length[snake]; }
+	int Score(int snake) const { return score[snake]; }
+	int HeadX(int snake) const { return headX[snake]; }
+	int HeadZ(int snake) const { return headZ[snake]; }
+	// segment 0 is the head, Length() - 1 the tail
+	int Segment(int snake, int i) const { return segments[ringStart[snake] + ((headSlot[snake] - i) & ringMask[snake])]; }
+
+	// ints in the segment pool, used or free
+	size_t SegmentPoolSize() const { return segments.size(); }
+	// FNV-1a over the snakes, their bodies and the eggs, two runs that agree on it played out the same
+	uint64_t Checksum() const;
+
+private:
+	static const unsigned int SNAKES_PER_JOB = 256;
+	static const int MIN_RING_SHIFT = 4; // smallest ring, 16 segments
+	static const int RING_CLASSES = 24;
+
+	int width, height;
+	SnakeRandom rng;	// eggs and respawns, only used while committing
+	int eggTarget;
+	int growthPerEgg;
+	int startLength;
+	bool respawnBots;
+	int aliveCount;
+	unsigned long long ticks;
+
+	// per snake
+	std::vector<unsigned char> alive;
+	std::vector<unsigned char> control;
+	std::vector<unsigned char> direction;		// the way the head went last tick
+	std::vector<unsigned char> nextDirection;
+	std::vector<unsigned char> result;
+	std::vector<int> headX, headZ;
+	std::vector<int> length;
+	std::vector<int> pendingGrowth;
+	std::vector<int> score;
+	std::vector<int> ringStart;		// first segment of the snake's ring in the pool
+	std::vector<int> ringMask;		// ring size - 1
+	std::vector<int> headSlot;
+	std::vector<int> targetEgg;		// cell a bot is heading for
+	std::vector<SnakeRandom> botRng;	// split off rng, so deciding in parallel stays deterministic
+	std::vector<int> moveTo;		// cell the head goes to this tick, -1 off the arena
+
+	// pooled rings, a free list per size class
+	std::vector<int> segments;
+	std::vector<int> freeRings[RING_CLASSES];
+
+	// claim phase marks, cleared again after resolving
+	ArenaBitset claimed;
+	ArenaBitset contested;
+	ArenaBitset leaving;
+
+	ArenaGrid grid;
+	JobSystem jobs;
+
+	int addSnake(SnakeControl control);
+	bool fits(int x, int z, SnakeDirection direction) const;
+	void place(int snake, int x, int z, SnakeDirection direction);
+	bool placeAnywhere(int snake);
+	int allocateRing(int sizeClass);
+	void freeRing(int snake);
+	void growRing(int snake);
+	int tail(int snake) const { return Segment(snake, length[snake] - 1); }
+
+	// size class of a ring of at least size segments
+	static int sizeClassOf(int size);
+	void decide(int snake);
+	SnakeDirection botDirection(int snake);
+	void resolve(int snake);
+	void kill(int snake);
+	void topUpEggs();
+};
@@ -0,0 +1,113 @@
+#include "SnakeBatch.h"
+
+#include <cstring>
+
+SnakeBatch::SnakeBatch(unsigned int games, int width, int height, uint64_t seed, int threads) : width(width), height(height), seed(seed),
+	startLength(4), growthPerEgg(1), starveTicks(width * height * 4), planeWords(SnakeSim::OccupancyWords(width, height)), lastWordMask(~0ull),
+	jobs(JobSystem::WorkersFor(threads))
+{
+	unsigned int bodySize = SnakeSim::BodySize(width, height);
+	unsigned int freeCellsSize = SnakeSim::FreeCellsSize(width, height);
+	bodies.resize((size_t)games * bodySize);
+	occupancy.resize((size_t)games * planeWords);
+	freeCells.resize((size_t)games * freeCellsSize);
+	sims.reserve(games);
+	for (unsigned int g = 0; g < games; g++)
+		sims.push_back(SnakeSim(width, height, &bodies[(size_t)g * bodySize], &occupancy[(size_t)g * planeWords], &freeCells[(size_t)g * freeCellsSize]));
+	episodes.resize(games, 0);
+	sinceEgg.resize(games, 0);
+
+	int cells = width * height;
+	if (cells & 63)
+		lastWordMask = ~(~0ull << (cells & 63));
+	wallPlane.resize(planeWords, 0);
+	for (int z = 0; z < height; z++) {
+		for (int x = 0; x < width; x++) {
+			if (x == 0 || z == 0 || x == width - 1 || z == height - 1)
+				wallPlane[(z * width + x) >> 6] |= 1ull << ((z * width + x) & 63);
+		}
+	}
+}
+
+//the snake starts in the middle facing up, its body below the head. every episode of every game has its own seed
+void SnakeBatch::resetGame(unsigned int game)
+{
+	SnakeSim &sim = sims[game];
+	sim.Reset(width / 2, height / 2, SNAKE_UP, startLength, SnakeSeed(seed, ((uint64_t)episodes[game] << 32) | game));
+	sim.SetGrowthPerEgg(growthPerEgg);
+	sinceEgg[game] = 0;
+}
+
+void SnakeBatch::observe(unsigned int game, uint64_t* observation) const
+{
+	const SnakeSim &sim = sims[game];
+	uint64_t* head = observation + SNAKE_PLANE_HEAD * planeWords;
+	uint64_t* body = observation + SNAKE_PLANE_BODY * planeWords;
+	uint64_t* egg = observation + SNAKE_PLANE_EGG * planeWords;
+	uint64_t* walls = observation + SNAKE_PLANE_WALLS * planeWords;
+
+	memset(head, 0, planeWords * sizeof(uint64_t));
+	int headCell = sim.Segment(0);
+	head[headCell >> 6] = 1ull << (headCell & 63);
+
+	//the bitset has the cells past the end set, the plane mustn't
+	memcpy(body, sim.Occupancy(), planeWords * sizeof(uint64_t));
+	body[planeWords - 1] &= lastWordMask;
+
+	memset(egg, 0, planeWords * sizeof(uint64_t));
+	if (sim.Egg() >= 0)
+		egg[sim.Egg() >> 6] = 1ull << (sim.Egg() & 63);
+
+	memcpy(walls, &wallPlane[0], planeWords * sizeof(uint64_t));
+}
+
+void SnakeBatch::Reset(uint64_t* observations)
+{
+	size_t words = ObservationWords();
+	jobs.ParallelFor(0, Games(), GAMES_PER_JOB, [&](unsigned int first, unsigned int last) {
+		for (unsigned int g = first; g < last; g++) {
+			episodes[g] = 0;
+			resetGame(g);
+			observe(g, observations + g * words);
+		}
+	});
+}
+
+void SnakeBatch::Step(const int* actions, uint64_t* observations, float* rewards, unsigned char* dones)
+{
+	size_t words = ObservationWords();
+	jobs.ParallelFor(0, Games(), GAMES_PER_JOB, [&](unsigned int first, unsigned int last) {
+		for (unsigned int g = first; g < last; g++) {
+			SnakeSim &sim = sims[g];
+			sim.Turn((SnakeDirection)(actions[g] & 3));
+			SnakeTickResult result = sim.Tick();
+
+			float reward = 0.0f;
+			bool done = false;
+			switch (result) {
+			case SNAKE_MOVED:
+				done = ++sinceEgg[g] >= starveTicks;
+				break;
+			case SNAKE_ATE:
+				reward = 1.0f;
+				sinceEgg[g] = 0;
+				break;
+			case SNAKE_FILLED:
+				reward = 1.0f;
+				done = true;
+				break;
+			default:
+				reward = -1.0f;
+				done = true;
+				break;
+			}
+			rewards[g] = reward;
+			dones[g] = done ? 1 : 0;
+			if (done) {
+				episodes[g]++;
+				resetGame(g);
+			}
+			observe(g, observations + g * words);
+		}
+	});
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "SnakeSim.h"
+
+// observation planes, in this order, each one bit per cell laid out like the SnakeSim bitset
+enum SnakeBatchPlane {
+	SNAKE_PLANE_HEAD,
+	SNAKE_PLANE_BODY,	// every segment including the head
+	SNAKE_PLANE_EGG,
+	SNAKE_PLANE_WALLS,	// cells with a wall on the other side of them, the edge of the grid
+	SNAKE_PLANE_COUNT
+};
+
+// Thousands of independent games stepped together, for training agents. Step takes one action per game and
+// writes every game's observation, reward and done flag into arrays the caller owns, one entry (or one block of
+// ObservationWords() words) per game back to back. A game that ends is reset straight away with its next seed,
+// so the observation after a done is the first of the new episode.
+// The games' ring buffers, bitsets and free cell lists sit in three big blocks and the per game counters in arrays
+// of their own, a step never allocates. Stepping is spread over a JobSystem, so a batch must be used from the
+// thread that created it.
+class SnakeBatch
+{
+public:
+	// threads in total stepping the games, -1 is every hardware thread, 0 or 1 steps everything on the calling thread
+	SnakeBatch(unsigned int games, int width, int height, uint64_t seed, int threads = -1);
+
+	// take effect from the next Reset
+	void SetStartLength(int cells) { startLength = cells; }
+	void SetGrowthPerEgg(int cells) { growthPerEgg = cells; }
+	// an episode stops (done, reward 0) after this many ticks without an egg
+	void SetStarveTicks(int ticks) { starveTicks = ticks; }
+
+	unsigned int Games() const { return (unsigned int)sims.size(); }
+	// 64 bit words of one game's observation, all planes
+	size_t ObservationWords() const { return planeWords * SNAKE_PLANE_COUNT; }
+
+	// starts every game over, episode counters included
+	void Reset(uint64_t* observations);
+	// actions are SnakeDirections. rewards: +1 for an egg, -1 for dying, 0 otherwise
+	void Step(const int* actions, uint64_t* observations, float* rewards, unsigned char* dones);
+
+	const SnakeSim &Game(unsigned int game) const { return sims[game]; }
+	unsigned int Episode(unsigned int game) const { return episodes[game]; }
+
+private:
+	static const unsigned int GAMES_PER_JOB = 256;
+
+	int width, height;
+	uint64_t seed;
+	int startLength;
+	int growthPerEgg;
+	int starveTicks;
+	size_t planeWords;
+
+	std::vector<int> bodies;			// every game's ring buffer back to back
+	std::vector<uint64_t> occupancy;	// and bitset
+	std::vector<int> freeCells;			// and free cell list
+	std::vector<SnakeSim> sims;
+
+	// per game
+	std::vector<unsigned int> episodes;
+	std::vector<int> sinceEgg;
+
+	std::vector<uint64_t> wallPlane; // the same for every game
+	uint64_t lastWordMask;			 // cells actually in the last word of a plane
+
+	JobSystem jobs;
+
+	void resetGame(unsigned int game);
+	void observe(unsigned int game, uint64_t* observation) const;
+};
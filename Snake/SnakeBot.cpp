@@ -0,0 +1,419 @@
+#include "SnakeBot.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+SnakeDirection GreedyMove(const SnakeSim &sim)
+{
+	static const int stepX[4] = { 0, 1, 0, -1 };
+	static const int stepZ[4] = { -1, 0, 1, 0 };
+	int egg = sim.Egg() >= 0 ? sim.Egg() : 0;
+	int eggX = egg % sim.Width(), eggZ = egg / sim.Width();
+	int best = -1, bestDistance = 0;
+	for (int d = 0; d < 4; d++) {
+		int x = sim.HeadX() + stepX[d], z = sim.HeadZ() + stepZ[d];
+		if (x < 0 || z < 0 || x >= sim.Width() || z >= sim.Height() || sim.Occupied(x, z))
+			continue;
+		int distance = abs(x - eggX) + abs(z - eggZ);
+		if (best < 0 || distance < bestDistance) {
+			best = d;
+			bestDistance = distance;
+		}
+	}
+	return best >= 0 ? (SnakeDirection)best : sim.Direction();
+}
+
+static const int STEP_X[4] = { 0, 1, 0, -1 };
+static const int STEP_Z[4] = { -1, 0, 1, 0 };
+
+//the way from the head to a cell next to it
+static SnakeDirection stepDirection(const SnakeSim &sim, int cell)
+{
+	int x = cell % sim.Width(), z = cell / sim.Width();
+	if (z < sim.HeadZ())
+		return SNAKE_UP;
+	if (z > sim.HeadZ())
+		return SNAKE_DOWN;
+	return x > sim.HeadX() ? SNAKE_RIGHT : SNAKE_LEFT;
+}
+
+SnakeAutopilot::SnakeAutopilot(int width, int height) : width(width), height(height), generation(0), bodyGeneration(0)
+{
+	int cells = width * height;
+	stamp.resize(cells, 0);
+	cost.resize(cells);
+	cameFrom.resize(cells);
+	closed.resize(cells);
+	bodyStamp.resize(cells, 0);
+	freeAt.resize(cells);
+	//an A* cell can be pushed once for each neighbour that improves it
+	open.reserve(cells * 4);
+	queue.reserve(cells);
+	path.reserve(cells);
+	virtualBody.reserve(cells * 2);
+}
+
+//stamps wrap after four billion searches, then the arrays get cleared once
+unsigned int SnakeAutopilot::nextGeneration()
+{
+	if (++generation == 0) {
+		std::fill(stamp.begin(), stamp.end(), 0);
+		generation = 1;
+	}
+	return generation;
+}
+
+//is the cell still covered by the snake when the head would get there after this many moves
+bool SnakeAutopilot::blocked(int cell, int steps) const
+{
+	return bodyStamp[cell] == bodyGeneration && steps < freeAt[cell];
+}
+
+SnakeDirection SnakeAutopilot::Move(const SnakeSim &sim)
+{
+	if (!sim.Alive())
+		return sim.Direction();
+
+	//segment i leaves its cell after length - i moves, later if the snake is still growing
+	if (++bodyGeneration == 0) {
+		std::fill(bodyStamp.begin(), bodyStamp.end(), 0);
+		bodyGeneration = 1;
+	}
+	int length = sim.Length();
+	for (int i = 0; i < length; i++) {
+		int cell = sim.Segment(i);
+		bodyStamp[cell] = bodyGeneration;
+		freeAt[cell] = length - i + sim.PendingGrowth();
+	}
+
+	if (sim.Egg() >= 0 && findPath(sim, sim.Egg()) && tailReachableAfter(sim))
+		return stepDirection(sim, path[0]);
+
+	//no safe way to the egg: the move with the most room, where being able to follow the tail beats any room.
+	//between those, the one that takes longest to get back to the body stretches the snake out the most
+	int best = -1, bestScore = -1, bestTailSteps = -1;
+	for (int d = 0; d < 4; d++) {
+		if (((d + 2) & 3) == sim.Direction() && length > 1)
+			continue;
+		int x = sim.HeadX() + STEP_X[d], z = sim.HeadZ() + STEP_Z[d];
+		if (x < 0 || z < 0 || x >= width || z >= height)
+			continue;
+		int cell = z * width + x;
+		if (blocked(cell, 1))
+			continue;
+		int tailSteps;
+		int score = floodFill(cell, tailSteps);
+		if (tailSteps >= 0)
+			score += width * height;
+		if (score > bestScore || (score == bestScore && tailSteps > bestTailSteps)) {
+			best = d;
+			bestScore = score;
+			bestTailSteps = tailSteps;
+		}
+	}
+	return best >= 0 ? (SnakeDirection)best : sim.Direction();
+}
+
+//A* from the head, manhattan distance heuristic. fills path with the cells after the head, ending at goal
+bool SnakeAutopilot::findPath(const SnakeSim &sim, int goal)
+{
+	unsigned int g = nextGeneration();
+	int head = sim.Segment(0);
+	int goalX = goal % width, goalZ = goal / width;
+
+	open.clear();
+	stamp[head] = g;
+	cost[head] = 0;
+	cameFrom[head] = -1;
+	closed[head] = 0;
+	open.push_back((uint64_t)(abs(sim.HeadX() - goalX) + abs(sim.HeadZ() - goalZ)) << 32 | (uint64_t)head);
+
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		int cell = (int)(open.back() & 0xFFFFFFFF);
+		open.pop_back();
+		if (closed[cell])
+			continue;
+		closed[cell] = 1;
+
+		if (cell == goal) {
+			path.clear();
+			for (int c = goal; c != head; c = cameFrom[c])
+				path.push_back(c);
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		int x = cell % width, z = cell / width;
+		int steps = cost[cell] + 1;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + STEP_X[d], nz = z + STEP_Z[d];
+			if (nx < 0 || nz < 0 || nx >= width || nz >= height)
+				continue;
+			int next = nz * width + nx;
+			if (blocked(next, steps))
+				continue;
+			if (stamp[next] != g) {
+				stamp[next] = g;
+				cost[next] = steps + 1;
+				closed[next] = 0;
+			}
+			if (closed[next] || steps >= cost[next])
+				continue;
+			cost[next] = steps;
+			cameFrom[next] = cell;
+			open.push_back((uint64_t)(steps + abs(nx - goalX) + abs(nz - goalZ)) << 32 | (uint64_t)next);
+			std::push_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		}
+	}
+	return false;
+}
+
+//where the snake would be after following path and eating, and whether its head could then get to its tail
+bool SnakeAutopilot::tailReachableAfter(const SnakeSim &sim)
+{
+	int length = sim.Length();
+	int moves = (int)path.size();
+	//growth still owed keeps the tail in place for that many of the moves
+	int grownOnTheWay = sim.PendingGrowth() < moves ? sim.PendingGrowth() : moves;
+	int grown = length + grownOnTheWay;
+	//and once eaten, the tail sits still for this many ticks
+	int tailWait = sim.PendingGrowth() - grownOnTheWay + sim.GrowthPerEgg();
+	if (grown + sim.GrowthPerEgg() >= width * height)
+		return true; //that egg fills the grid
+	if (grown <= 2)
+		return true;
+
+	//the body tail to head, then the path: the snake is the last grown cells of that
+	virtualBody.clear();
+	for (int i = length - 1; i >= 0; i--)
+		virtualBody.push_back(sim.Segment(i));
+	virtualBody.insert(virtualBody.end(), path.begin(), path.end());
+	size_t first = virtualBody.size() > (size_t)grown ? virtualBody.size() - grown : 0;
+
+	unsigned int g = nextGeneration();
+	for (size_t i = first; i < virtualBody.size(); i++)
+		stamp[virtualBody[i]] = g;
+	int tail = virtualBody[first];
+	int head = virtualBody.back();
+
+	//plain flood fill from the new head, the tail counts as reached when we could step onto it after it has moved
+	queue.clear();
+	queue.push_back(head);
+	cost[head] = 0;
+	for (size_t q = 0; q < queue.size(); q++) {
+		int cell = queue[q];
+		int x = cell % width, z = cell / width;
+		int steps = cost[cell] + 1;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + STEP_X[d], nz = z + STEP_Z[d];
+			if (nx < 0 || nz < 0 || nx >= width || nz >= height)
+				continue;
+			int next = nz * width + nx;
+			if (next == tail && steps > tailWait)
+				return true;
+			if (stamp[next] == g)
+				continue;
+			stamp[next] = g;
+			cost[next] = steps;
+			queue.push_back(next);
+		}
+	}
+	return false;
+}
+
+//cells reachable from start, which the head would enter on the next move. tailSteps is how many moves it takes
+//to first reach a cell the snake has left by then (so following the tail from there works), -1 if never
+int SnakeAutopilot::floodFill(int start, int &tailSteps)
+{
+	unsigned int g = nextGeneration();
+	tailSteps = -1;
+	queue.clear();
+	queue.push_back(start);
+	stamp[start] = g;
+	cost[start] = 1;
+	for (size_t q = 0; q < queue.size(); q++) {
+		int cell = queue[q];
+		int x = cell % width, z = cell / width;
+		int steps = cost[cell] + 1;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + STEP_X[d], nz = z + STEP_Z[d];
+			if (nx < 0 || nz < 0 || nx >= width || nz >= height)
+				continue;
+			int next = nz * width + nx;
+			if (stamp[next] == g || blocked(next, steps))
+				continue;
+			if (tailSteps < 0 && bodyStamp[next] == bodyGeneration)
+				tailSteps = steps;
+			stamp[next] = g;
+			cost[next] = steps;
+			queue.push_back(next);
+		}
+	}
+	return (int)queue.size();
+}
+
+SnakeCycleBot::SnakeCycleBot(int width, int height) : width(width), height(height), swapSlot(-1), spareCell(-1), shortcutLimit(0.5f),
+	alignedMoves(0), expectedTicks(0)
+{
+	order.resize(width * height, -1);
+	if (width < 2 || height < 2)
+		return;
+	cycle.reserve(width * height);
+
+	//down column 0, then back and forth along the rows over the other columns, needs an even number of rows.
+	//with an odd number the same thing is done with the grid on its side
+	if (height % 2 == 0 || width % 2 == 0) {
+		bool transposed = height % 2 != 0;
+		int w = transposed ? height : width;
+		int h = transposed ? width : height;
+		addCell(0, 0, transposed);
+		for (int z = 0; z < h; z++) {
+			for (int i = 1; i < w; i++)
+				addCell(z % 2 == 0 ? i : w - i, z, transposed);
+		}
+		for (int z = h - 1; z > 0; z--)
+			addCell(0, z, transposed);
+		return;
+	}
+
+	//both odd: the rows down to the last two as above, then the last two rows a column at a time back towards
+	//column 0, leaving the bottom right corner out
+	addCell(0, 0, false);
+	for (int z = 0; z < height - 2; z++) {
+		for (int i = 1; i < width; i++)
+			addCell(z % 2 == 0 ? i : width - i, z, false);
+	}
+	addCell(width - 1, height - 2, false);
+	swapSlot = (int)cycle.size();
+	for (int x = width - 2; x > 0; x--) {
+		bool down = (width - 2 - x) % 2 == 0;
+		addCell(x, down ? height - 2 : height - 1, false);
+		addCell(x, down ? height - 1 : height - 2, false);
+	}
+	for (int z = height - 1; z > 0; z--)
+		addCell(0, z, false);
+	spareCell = (height - 1) * width + width - 1;
+}
+
+void SnakeCycleBot::addCell(int x, int z, bool transposed)
+{
+	int cell = transposed ? x * width + z : z * width + x;
+	order[cell] = (int)cycle.size();
+	cycle.push_back(cell);
+}
+
+//free by the time the head gets there next tick
+bool SnakeCycleBot::enterable(const SnakeSim &sim, int cell) const
+{
+	return !sim.Occupied(cell) || (cell == sim.Segment(sim.Length() - 1) && sim.PendingGrowth() == 0);
+}
+
+//puts the egg's cell into the cycle in place of the one it shares a slot with, if the body isn't on that one.
+//the tail may be, if the head is about to take the egg and the tail leaves as it does
+bool SnakeCycleBot::trySwap(const SnakeSim &sim)
+{
+	int slotCell = cycle[swapSlot];
+	bool tailLeaving = slotCell == sim.Segment(sim.Length() - 1) && sim.Segment(0) == cycle[swapSlot - 1] && sim.PendingGrowth() == 0;
+	if (sim.Occupied(slotCell) && !tailLeaving)
+		return false;
+	order[slotCell] = -1;
+	order[spareCell] = swapSlot;
+	cycle[swapSlot] = spareCell;
+	spareCell = slotCell;
+	return true;
+}
+
+SnakeDirection SnakeCycleBot::Move(const SnakeSim &sim)
+{
+	if (!sim.Alive() || cycle.empty())
+		return sim.Direction();
+
+	//anything but the tick after our last move is a game we haven't been steering
+	if (sim.Ticks() != expectedTicks)
+		alignedMoves = 0;
+	expectedTicks = sim.Ticks() + 1;
+	bool aligned = alignedMoves >= sim.Length();
+
+	int n = (int)cycle.size();
+	//on an odd grid the snake only fits on the cycle up to its n cells, one short of the grid, and an egg in the
+	//stretch ahead can only be stepped around by jumping over it to a cell before the tail. so it stops eating while
+	//that stretch is still a row and a column long, with room for a couple of eggs it can't get round
+	bool roomToGrow = swapSlot < 0 || sim.Length() + sim.PendingGrowth() + sim.GrowthPerEgg() * 3 <= n - width - height;
+	if (aligned && swapSlot >= 0 && sim.Egg() == spareCell && roomToGrow)
+		trySwap(sim);
+	//and the other way round, an egg that would outgrow it is taken out of the cycle if it's on the swapping cell
+	if (aligned && swapSlot >= 0 && sim.Egg() == cycle[swapSlot] && !roomToGrow)
+		trySwap(sim);
+
+	int head = sim.Segment(0);
+	int tail = sim.Segment(sim.Length() - 1);
+	//a snake of one can still not turn back on itself
+	int behind = -1;
+	SnakeDirection back = (SnakeDirection)((sim.Direction() + 2) & 3);
+	int backX = sim.HeadX() + STEP_X[back], backZ = sim.HeadZ() + STEP_Z[back];
+	if (backX >= 0 && backZ >= 0 && backX < width && backZ < height)
+		behind = backZ * width + backX;
+
+	if (!aligned && (order[head] < 0 || cycle[(order[head] + 1) % n] == behind || !enterable(sim, cycle[(order[head] + 1) % n]))) {
+		//off the cycle, only ever before lining up: any free cell, lining up starts over from there
+		alignedMoves = 0;
+		for (int d = 0; d < 4; d++) {
+			int x = sim.HeadX() + STEP_X[d], z = sim.HeadZ() + STEP_Z[d];
+			if (d == back || x < 0 || z < 0 || x >= width || z >= height)
+				continue;
+			if (enterable(sim, z * width + x))
+				return (SnakeDirection)d;
+		}
+		return sim.Direction();
+	}
+
+	//lined up, the cycle is never left again
+	int next = cycle[(order[head] + 1) % n];
+	alignedMoves++;
+	if (!aligned || order[tail] < 0)
+		return stepDirection(sim, next);
+
+	int headIndex = order[head];
+	int toTail = (order[tail] - headIndex + n) % n;
+	int toEgg = sim.Egg() >= 0 && order[sim.Egg()] >= 0 ? (order[sim.Egg()] - headIndex + n) % n : n;
+	if (!roomToGrow && toEgg < toTail) {
+		//eating would outgrow the cycle, so the egg is jumped over from the first cell on the way to it that has a
+		//neighbour past it and before the tail
+		for (int d = 0; d < 4; d++) {
+			int x = sim.HeadX() + STEP_X[d], z = sim.HeadZ() + STEP_Z[d];
+			if (x < 0 || z < 0 || x >= width || z >= height)
+				continue;
+			int cell = z * width + x;
+			int jump = order[cell] >= 0 && cell != behind ? (order[cell] - headIndex + n) % n : 0;
+			if (jump > toEgg && (jump < toTail || (jump == toTail && enterable(sim, cell))) && toTail - jump >= sim.PendingGrowth())
+				return stepDirection(sim, cell);
+		}
+		return stepDirection(sim, next);
+	}
+
+	//jumping k cells along the cycle leaves k - 1 empty cells inside the stretch of cycle from tail to head, until
+	//the tail gets to them. the snake can grow into the rest of the cycle meanwhile, so the stretch, with those
+	//cells and whatever the snake still has to grow, is kept to shortcutLimit of the cycle. it mustn't jump over
+	//the egg either, or it would take a lap to come back for it
+	int stretch = n - toTail + 1;
+	int limit = (int)(shortcutLimit * n) - stretch - sim.PendingGrowth() - sim.GrowthPerEgg();
+	if (limit <= 1)
+		return stepDirection(sim, next);
+	int bestJump = 1;
+	for (int d = 0; d < 4; d++) {
+		int x = sim.HeadX() + STEP_X[d], z = sim.HeadZ() + STEP_Z[d];
+		if (x < 0 || z < 0 || x >= width || z >= height)
+			continue;
+		int cell = z * width + x;
+		if (order[cell] < 0 || cell == behind)
+			continue;
+		int jump = (order[cell] - headIndex + n) % n;
+		if (jump > bestJump && jump <= limit && jump <= toEgg) {
+			bestJump = jump;
+			next = cell;
+		}
+	}
+	return stepDirection(sim, next);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SnakeSim.h"
+
+// Simple players for SnakeSim, for headless runs and benchmarks. Each looks at the game and returns the
+// direction to hand to Turn before the next Tick.
+
+// the free cell next to the head that is closest to the egg, straight on when none is free
+SnakeDirection GreedyMove(const SnakeSim &sim);
+
+// Plans with A* to the egg and only takes the path when, having eaten, the snake could still reach its own tail,
+// which means it can always keep chasing it and can't have boxed itself in. Otherwise it takes the move that
+// leaves the most room (preferring ones from which the tail is still reachable) and tries again next tick.
+// Body cells count as free from the tick the tail will have left them, so paths can run along the snake's own tail.
+// All search state is allocated once for the grid size and reused; a stamp per cell, bumped each search, says
+// whether the rest of that cell's entries belong to the current search, so nothing is cleared between searches.
+class SnakeAutopilot
+{
+public:
+	SnakeAutopilot(int width, int height);
+
+	SnakeDirection Move(const SnakeSim &sim);
+
+private:
+	int width, height;
+
+	// per cell
+	std::vector<unsigned int> stamp;	// search generation the entries below are from
+	std::vector<int> cost;				// A*: moves from the head
+	std::vector<int> cameFrom;
+	std::vector<unsigned char> closed;
+	std::vector<unsigned int> bodyStamp;
+	std::vector<int> freeAt;			// ticks until the snake has left the cell, valid when bodyStamp is current
+	unsigned int generation;
+	unsigned int bodyGeneration;
+
+	std::vector<uint64_t> open;	// heap of (f << 32 | cell), reserved for every cell
+	std::vector<int> queue;		// flood fills
+	std::vector<int> path;		// head to egg, without the head
+	std::vector<int> virtualBody;
+
+	unsigned int nextGeneration();
+	bool findPath(const SnakeSim &sim, int goal);
+	bool tailReachableAfter(const SnakeSim &sim);
+	int floodFill(int start, int &tailSteps);
+	bool blocked(int cell, int steps) const;
+};
+
+// Follows a Hamiltonian cycle of the grid: once lined up the body always lies along the cycle in order, so every
+// cell between the head and the tail going forwards is free and the snake fills the grid. While the snake is short
+// it cuts across to cells further along the cycle, as long as that doesn't skip the egg or get within growing
+// distance of the tail.
+// A grid with an odd number of cells has no such cycle. Then the cycle leaves out the bottom right corner and the
+// cell diagonally in from it takes turns with it: both fit between the same two cycle cells, so when the egg lands
+// on the one that's out the two are swapped. The snake can't fill such a grid. It stops eating while the free
+// stretch of cycle ahead is still about a row and a column long, jumping over eggs to cells past them (or swapping
+// an egg out of the cycle), and circles until the game is called off as starved.
+// A move only looks at the head's neighbours and a few indices.
+class SnakeCycleBot
+{
+public:
+	SnakeCycleBot(int width, int height);
+
+	// false for grids only one cell wide or high, Move then just goes straight on
+	bool HasCycle() const { return !cycle.empty(); }
+	// shortcuts are only taken while the snake, with the gaps they leave in it, covers less than this much of the
+	// cycle. 0 turns them off, 1 risks running into the tail
+	void SetShortcutLimit(float fraction) { shortcutLimit = fraction; }
+
+	SnakeDirection Move(const SnakeSim &sim);
+
+private:
+	int width, height;
+	std::vector<int> cycle;	// cells in cycle order
+	std::vector<int> order;	// every cell's index in cycle, -1 for the one left out
+	int swapSlot;			// odd grids: the index the two cells take turns at, -1 otherwise
+	int spareCell;			// and the one that's out
+	float shortcutLimit;
+
+	// after a reset the body only lies along the cycle once the snake has moved its length along it
+	int alignedMoves;
+	unsigned long long expectedTicks;
+
+	void addCell(int x, int z, bool transposed);
+	bool trySwap(const SnakeSim &sim);
+	bool enterable(const SnakeSim &sim, int cell) const;
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+
+// splitmix64 of seed and index, for deriving a different well spread seed for every game of a run
+inline uint64_t SnakeSeed(uint64_t seed, uint64_t index)
+{
+	uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// xoshiro256**, the random numbers every simulation draws from. Only integer arithmetic on fixed width types, so a
+// seed gives the same sequence on every compiler and machine, which replays, lockstep play and regression runs
+// rely on. Split hands out a generator 2^128 draws further along, so a game can give each of its parts (eggs,
+// bots, ...) a stream of its own without any of them overlapping.
+class SnakeRandom
+{
+public:
+	explicit SnakeRandom(uint64_t seed = 0) { Seed(seed); }
+	// stream picks one of many independent sequences for the same seed
+	SnakeRandom(uint64_t seed, uint64_t stream) { Seed(SnakeSeed(seed, stream)); }
+
+	// the four words of state are splitmix64 of the seed, never all 0
+	void Seed(uint64_t seed)
+	{
+		for (int i = 0; i < 4; i++)
+			state[i] = SnakeSeed(seed, i);
+	}
+
+	uint64_t Next()
+	{
+		uint64_t result = rotl(state[1] * 5, 7) * 9;
+		uint64_t t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+		return result;
+	}
+
+	// uniform in [0, n) by multiplying instead of %, n up to 2^32
+	uint32_t Below(uint32_t n) { return (uint32_t)(((Next() >> 32) * n) >> 32); }
+
+	// a generator that carries on from here, this one jumps 2^128 draws ahead so the two never meet
+	SnakeRandom Split()
+	{
+		SnakeRandom split = *this;
+		jump();
+		return split;
+	}
+
+	// the raw state, for saving a game and picking it up again exactly where it was
+	uint64_t State(int word) const { return state[word]; }
+	void SetState(const uint64_t words[4])
+	{
+		for (int i = 0; i < 4; i++)
+			state[i] = words[i];
+	}
+
+	bool operator==(const SnakeRandom &other) const
+	{
+		return state[0] == other.state[0] && state[1] == other.state[1] && state[2] == other.state[2] && state[3] == other.state[3];
+	}
+	bool operator!=(const SnakeRandom &other) const { return !(*this == other); }
+
+private:
+	uint64_t state[4];
+
+	static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+	void jump()
+	{
+		static const uint64_t JUMP[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+		uint64_t jumped[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 4; i++) {
+			for (int b = 0; b < 64; b++) {
+				if (JUMP[i] & (1ull << b)) {
+					for (int w = 0; w < 4; w++)
+						jumped[w] ^= state[w];
+				}
+				Next();
+			}
+		}
+		for (int w = 0; w < 4; w++)
+			state[w] = jumped[w];
+	}
+};
+
+// Every free cell of a grid in a list, and where in the list each cell is, so taking a cell, giving it back and
+// picking a random free one are all O(1) however full the grid is. Taking a cell moves the last free one into its
+// place. Works on 2 * cellCount ints the owner provides.
+class FreeCellList
+{
+public:
+	static unsigned int StorageSize(int cellCount) { return (unsigned int)cellCount * 2; }
+
+	FreeCellList() : cells(0), slots(0), cellCount(0), count(0) {}
+
+	void Attach(int* storage, int cellCount)
+	{
+		cells = storage;
+		slots = storage + cellCount;
+		this->cellCount = cellCount;
+		Reset();
+	}
+
+	// every cell free again
+	void Reset()
+	{
+		for (int i = 0; i < cellCount; i++) {
+			cells[i] = i;
+			slots[i] = i;
+		}
+		count = cellCount;
+	}
+
+	bool Attached() const { return cells != 0; }
+	int Count() const { return count; }
+	bool Free(int cell) const { return slots[cell] < count; }
+	// the i-th free cell, the order is what Sample picks from
+	int Cell(int i) const { return cells[i]; }
+
+	// exactly these cells free in this order, every other one taken. false (and all free) if a cell is off the
+	// grid or listed twice
+	bool Assign(const int* freeList, int freeCount)
+	{
+		for (int i = 0; i < cellCount; i++)
+			slots[i] = -1;
+		for (int i = 0; i < freeCount; i++) {
+			int cell = freeList[i];
+			if ((unsigned int)cell >= (unsigned int)cellCount || slots[cell] >= 0) {
+				Reset();
+				return false;
+			}
+			cells[i] = cell;
+			slots[cell] = i;
+		}
+		count = freeCount;
+		int taken = freeCount;
+		for (int cell = 0; cell < cellCount; cell++) {
+			if (slots[cell] < 0) {
+				cells[taken] = cell;
+				slots[cell] = taken++;
+			}
+		}
+		return true;
+	}
+
+	void Take(int cell)
+	{
+		int slot = slots[cell];
+		if (slot >= count)
+			return;
+		swap(slot, --count);
+	}
+
+	void Release(int cell)
+	{
+		int slot = slots[cell];
+		if (slot < count)
+			return;
+		swap(slot, count++);
+	}
+
+	// there must be at least one
+	int Sample(SnakeRandom &random) const { return cells[random.Below((uint32_t)count)]; }
+
+private:
+	int* cells;		// the free ones first, count of them
+	int* slots;		// each cell's place in cells
+	int cellCount;
+	int count;
+
+	void swap(int a, int b)
+	{
+		int cellA = cells[a], cellB = cells[b];
+		cells[a] = cellB;
+		cells[b] = cellA;
+		slots[cellB] = a;
+		slots[cellA] = b;
+	}
+};
@@ -0,0 +1,244 @@
+#include "SnakeReplay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "ByteStream.h"
+
+//the file starts with these, then the version
+static const unsigned char REPLAY_MAGIC[4] = { 'S', 'N', 'R', 'P' };
+const unsigned int REPLAY_VERSION = 1;
+//biggest grid side a replay is believed about
+const int REPLAY_MAX_SIDE = 4096;
+//how far back, in runs, a copy may reach, and the fewest runs worth one
+const size_t COPY_MAX_DISTANCE = 256;
+const size_t COPY_MIN_RUNS = 3;
+
+SnakeReplayRecorder::SnakeReplayRecorder() : width(0), height(0), seed(0), keyframeInterval(SNAKE_REPLAY_KEYFRAME_INTERVAL), ticks(0), nextKeyframe(0),
+	firstDirection(SNAKE_UP), lastDirection(SNAKE_UP), keyframeCount(0)
+{
+}
+
+void SnakeReplayRecorder::Begin(const SnakeSim &sim, uint64_t seed, unsigned int keyframeInterval)
+{
+	width = sim.Width();
+	height = sim.Height();
+	this->seed = seed;
+	this->keyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+	ticks = 0;
+	firstDirection = sim.Direction();
+	lastDirection = firstDirection;
+	runs.clear();
+	keyframes.clear();
+	keyframeCount = 0;
+	addKeyframe(sim);
+}
+
+void SnakeReplayRecorder::addKeyframe(const SnakeSim &sim)
+{
+	std::vector<unsigned char> state;
+	sim.WriteState(state);
+	WriteVarint(keyframes, ticks);
+	WriteVarint(keyframes, state.size());
+	keyframes.insert(keyframes.end(), state.begin(), state.end());
+	keyframeCount++;
+	nextKeyframe = ticks + keyframeInterval;
+}
+
+void SnakeReplayRecorder::Record(const SnakeSim &sim)
+{
+	if (ticks == nextKeyframe)
+		addKeyframe(sim);
+	ticks++;
+	SnakeDirection direction = sim.NextDirection();
+	if (!runs.empty() && direction == lastDirection) {
+		runs.back().ticks++;
+		return;
+	}
+	if (runs.empty())
+		firstDirection = direction;
+	Run run = { 1, !runs.empty() && ((direction - lastDirection) & 3) == SNAKE_LEFT };
+	runs.push_back(run);
+	lastDirection = direction;
+}
+
+//header, then the runs as tokens: a literal is one varint, (ticks - 1) << 2 | left << 1, a copy is two,
+//(distance - 1) << 1 | 1 and runs - 1, repeating that many runs from distance runs back (they may overlap what
+//they produce, so a copy can repeat a short pattern many times). keyframes last
+void SnakeReplayRecorder::Write(std::vector<unsigned char> &out) const
+{
+	out.insert(out.end(), REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC));
+	WriteVarint(out, REPLAY_VERSION);
+	WriteVarint(out, width);
+	WriteVarint(out, height);
+	WriteFixed64(out, seed);
+	WriteVarint(out, ticks);
+	WriteVarint(out, firstDirection);
+
+	//greedy: the longest repeat of earlier runs within reach, a literal when there's none worth it
+	std::vector<unsigned char> tokens;
+	size_t i = 0;
+	while (i < runs.size()) {
+		size_t bestRuns = 0, bestDistance = 0;
+		for (size_t distance = 1; distance <= COPY_MAX_DISTANCE && distance <= i; distance++) {
+			size_t n = 0;
+			while (i + n < runs.size() && runs[i + n] == runs[i + n - distance])
+				n++;
+			if (n > bestRuns) {
+				bestRuns = n;
+				bestDistance = distance;
+			}
+		}
+		if (bestRuns >= COPY_MIN_RUNS) {
+			WriteVarint(tokens, (bestDistance - 1) << 1 | 1);
+			WriteVarint(tokens, bestRuns - 1);
+			i += bestRuns;
+			continue;
+		}
+		WriteVarint(tokens, (uint64_t)(runs[i].ticks - 1) << 2 | (runs[i].left ? 2 : 0));
+		i++;
+	}
+	WriteVarint(out, runs.size());
+	WriteVarint(out, tokens.size());
+	out.insert(out.end(), tokens.begin(), tokens.end());
+
+	WriteVarint(out, keyframeCount);
+	out.insert(out.end(), keyframes.begin(), keyframes.end());
+}
+
+SnakeReplay::SnakeReplay() : width(0), height(0), seed(0), ticks(0)
+{
+}
+
+bool SnakeReplay::Load(const unsigned char* data, size_t size)
+{
+	const unsigned char* end = data + size;
+	runStarts.clear();
+	runDirections.clear();
+	keyframeTicks.clear();
+	keyframeOffsets.clear();
+	keyframeData.clear();
+	ticks = 0;
+
+	uint64_t version;
+	if (size < sizeof(REPLAY_MAGIC) || memcmp(data, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0) {
+		std::cout << "ERROR::SNAKE_REPLAY::NOT_A_REPLAY" << std::endl;
+		return false;
+	}
+	data += sizeof(REPLAY_MAGIC);
+	if (!ReadVarint(data, end, version) || version != REPLAY_VERSION) {
+		std::cout << "ERROR::SNAKE_REPLAY::UNSUPPORTED_VERSION " << version << std::endl;
+		return false;
+	}
+
+	int direction, runCount, tokenBytes;
+	uint64_t recordedTicks;
+	bool ok = ReadVarint(data, end, width, REPLAY_MAX_SIDE) && width > 0 && ReadVarint(data, end, height, REPLAY_MAX_SIDE) && height > 0
+		&& ReadFixed64(data, end, seed) && ReadVarint(data, end, recordedTicks) && ReadVarint(data, end, direction, 3)
+		&& ReadVarint(data, end, runCount, (int)std::min<uint64_t>(recordedTicks, INT32_MAX))
+		&& ReadVarint(data, end, tokenBytes, (int)std::min<ptrdiff_t>(end - data, INT32_MAX));
+
+	//runs come out as their start tick and direction, a copy reads back runs decoded already
+	std::vector<unsigned int> runTicks;
+	std::vector<bool> runLeft;
+	const unsigned char* tokensEnd = ok ? data + tokenBytes : data;
+	while (ok && data < tokensEnd) {
+		uint64_t token, count;
+		ok = ReadVarint(data, tokensEnd, token);
+		if (!ok)
+			break;
+		if (!(token & 1)) {
+			ok = runTicks.size() < (size_t)runCount;
+			runTicks.push_back((unsigned int)(token >> 2) + 1);
+			runLeft.push_back((token & 2) != 0);
+			continue;
+		}
+		size_t distance = (size_t)(token >> 1) + 1;
+		ok = ReadVarint(data, tokensEnd, count) && distance <= runTicks.size() && count < (size_t)runCount - runTicks.size();
+		for (uint64_t c = 0; ok && c <= count; c++) {
+			runTicks.push_back(runTicks[runTicks.size() - distance]);
+			runLeft.push_back(runLeft[runLeft.size() - distance]);
+		}
+	}
+	unsigned long long tick = 0;
+	for (size_t r = 0; ok && r < runTicks.size(); r++) {
+		if (r > 0)
+			direction = (direction + (runLeft[r] ? SNAKE_LEFT : SNAKE_RIGHT)) & 3;
+		runStarts.push_back(tick);
+		runDirections.push_back((unsigned char)direction);
+		tick += runTicks[r];
+	}
+	ok = ok && runTicks.size() == (size_t)runCount && tick == recordedTicks;
+
+	uint64_t keyframeCount = 0;
+	ok = ok && ReadVarint(data, end, keyframeCount) && keyframeCount > 0;
+	for (uint64_t k = 0; ok && k < keyframeCount; k++) {
+		uint64_t keyframeTick, bytes;
+		ok = ReadVarint(data, end, keyframeTick) && ReadVarint(data, end, bytes) && bytes <= (uint64_t)(end - data) && keyframeTick <= recordedTicks
+			&& (keyframeTicks.empty() ? keyframeTick == 0 : keyframeTick > keyframeTicks.back());
+		if (!ok)
+			break;
+		keyframeTicks.push_back(keyframeTick);
+		keyframeOffsets.push_back(keyframeData.size());
+		keyframeData.insert(keyframeData.end(), data, data + bytes);
+		data += bytes;
+	}
+	if (!ok) {
+		std::cout << "ERROR::SNAKE_REPLAY::CORRUPT" << std::endl;
+		runStarts.clear();
+		runDirections.clear();
+		keyframeTicks.clear();
+		return false;
+	}
+	ticks = recordedTicks;
+	return true;
+}
+
+size_t SnakeReplay::runAt(unsigned long long tick) const
+{
+	return (size_t)(std::upper_bound(runStarts.begin(), runStarts.end(), tick) - runStarts.begin()) - 1;
+}
+
+SnakeDirection SnakeReplay::Input(unsigned long long tick) const
+{
+	return (SnakeDirection)runDirections[runAt(tick)];
+}
+
+bool SnakeReplay::Seek(SnakeSim &sim, unsigned long long tick) const
+{
+	if (keyframeTicks.empty() || sim.Width() != width || sim.Height() != height)
+		return false;
+	if (tick > ticks)
+		tick = ticks;
+	size_t keyframe = (size_t)(std::upper_bound(keyframeTicks.begin(), keyframeTicks.end(), tick) - keyframeTicks.begin()) - 1;
+	const unsigned char* data = &keyframeData[0] + keyframeOffsets[keyframe];
+	const unsigned char* end = keyframe + 1 < keyframeOffsets.size() ? &keyframeData[0] + keyframeOffsets[keyframe + 1] : &keyframeData[0] + keyframeData.size();
+	if (!sim.ReadState(data, end)) {
+		std::cout << "ERROR::SNAKE_REPLAY::BAD_KEYFRAME " << keyframeTicks[keyframe] << std::endl;
+		return false;
+	}
+	Play(sim, keyframeTicks[keyframe], tick);
+	return true;
+}
+
+//one Turn per run, the direction sticks until the next
+unsigned long long SnakeReplay::Play(SnakeSim &sim, unsigned long long tick, unsigned long long until) const
+{
+	if (until > ticks)
+		until = ticks;
+	if (tick >= until)
+		return tick;
+	for (size_t run = runAt(tick); tick < until && sim.Alive(); run++) {
+		unsigned long long runEnd = run + 1 < runStarts.size() ? runStarts[run + 1] : ticks;
+		if (runEnd > until)
+			runEnd = until;
+		sim.Turn((SnakeDirection)runDirections[run]);
+		while (tick < runEnd) {
+			tick++;
+			if (sim.Tick() >= SNAKE_HIT_WALL)
+				return tick;
+		}
+	}
+	return tick;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SnakeSim.h"
+
+// ticks between the full game states a replay keeps, seeking re-simulates at most this many
+const unsigned int SNAKE_REPLAY_KEYFRAME_INTERVAL = 1 << 17;
+
+// Records a SnakeSim game as the seed and the direction of every tick. Equal directions on consecutive ticks
+// become one run, a varint of its length and whether it turns left or right from the run before (it can't go
+// straight on or back), and runs that repeat a stretch of earlier runs, which a bot going round and round mostly
+// does, become a copy of that stretch. Every keyframe interval ticks the whole game state goes in as well
+// (SnakeSim::WriteState), so playback can start close to any tick.
+class SnakeReplayRecorder
+{
+public:
+	SnakeReplayRecorder();
+
+	// starts over, recording the game sim has just been reset into. seed is only kept to tell which game it was
+	void Begin(const SnakeSim &sim, uint64_t seed, unsigned int keyframeInterval = SNAKE_REPLAY_KEYFRAME_INTERVAL);
+	// the tick sim is about to play: call after Turn and right before Tick
+	void Record(const SnakeSim &sim);
+
+	unsigned long long Ticks() const { return ticks; }
+	// the replay up to now, appended to out
+	void Write(std::vector<unsigned char> &out) const;
+
+private:
+	// a run of ticks going the same way, turned left or right from the run before (always right for the first)
+	struct Run {
+		unsigned int ticks;
+		bool left;
+		bool operator==(const Run &other) const { return ticks == other.ticks && left == other.left; }
+	};
+
+	int width, height;
+	uint64_t seed;
+	unsigned int keyframeInterval;
+	unsigned long long ticks;
+	unsigned long long nextKeyframe;
+	SnakeDirection firstDirection;	// of the first run
+	SnakeDirection lastDirection;
+	std::vector<Run> runs;
+	std::vector<unsigned char> keyframes; // each its tick and byte count as varints, then the state
+	unsigned int keyframeCount;
+
+	void addKeyframe(const SnakeSim &sim);
+};
+
+// A replay read back: which direction every tick went, and the keyframes to seek with.
+class SnakeReplay
+{
+public:
+	SnakeReplay();
+
+	// false (with an ERROR:: line) when data isn't a replay this version can read or is cut short
+	bool Load(const unsigned char* data, size_t size);
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+	uint64_t Seed() const { return seed; }
+	unsigned long long Ticks() const { return ticks; }
+	size_t Keyframes() const { return keyframeTicks.size(); }
+
+	// the direction the game went on a tick, tick < Ticks()
+	SnakeDirection Input(unsigned long long tick) const;
+	// puts sim (Width() x Height()) in the state it was in right before tick: the last keyframe at or before it,
+	// then the ticks in between played again. false if the keyframe doesn't read back
+	bool Seek(SnakeSim &sim, unsigned long long tick) const;
+	// plays the recorded ticks from tick (sim must be in that tick's state) as fast as the rules go, up to until or
+	// the end of the game, whichever comes first. returns the tick it got to
+	unsigned long long Play(SnakeSim &sim, unsigned long long tick, unsigned long long until) const;
+
+private:
+	int width, height;
+	uint64_t seed;
+	unsigned long long ticks;
+
+	// first tick of each run and the way it goes, a run ends where the next starts
+	std::vector<unsigned long long> runStarts;
+	std::vector<unsigned char> runDirections;
+
+	std::vector<unsigned long long> keyframeTicks;
+	std::vector<size_t> keyframeOffsets; // into keyframeData
+	std::vector<unsigned char> keyframeData;
+
+	size_t runAt(unsigned long long tick) const;
+};
@@ -0,0 +1,407 @@
+#include "SnakeSim.h"
+
+#include <bitset>
+#include <climits>
+#include <cstring>
+
+#include "ByteStream.h"
+#include "SnakeSnapshot.h"
+
+//ring buffer a game starts with when it owns it
+const unsigned int FIRST_BODY_SIZE = 64;
+
+static const int STEP_X[4] = { 0, 1, 0, -1 };
+static const int STEP_Z[4] = { -1, 0, 1, 0 };
+
+SnakeSim::SnakeSim(int width, int height) : width(width), height(height), cellCount(width * height), body(NULL), mask(0),
+	headSlot(0), length(0), headX(0), headZ(0), occupancy(NULL), occupancyWords(OccupancyWords(width, height)), freeCellsListed(false),
+	direction(SNAKE_UP), nextDirection(SNAKE_UP), growthPerEgg(1), pendingGrowth(0), egg(-1), eggsEaten(0), alive(false), ticks(0), rng(1)
+{
+	unsigned int bodySize = BodySize(width, height);
+	ownedBody.resize(bodySize < FIRST_BODY_SIZE ? bodySize : FIRST_BODY_SIZE);
+	mask = (unsigned int)ownedBody.size() - 1;
+	ownedOccupancy.resize(occupancyWords);
+	body = &ownedBody[0];
+	occupancy = &ownedOccupancy[0];
+}
+
+SnakeSim::SnakeSim(int width, int height, int* bodyStorage, uint64_t* occupancyStorage, int* freeCellStorage) : width(width), height(height), cellCount(width * height),
+	body(bodyStorage), mask(BodySize(width, height) - 1), headSlot(0), length(0), headX(0), headZ(0), occupancy(occupancyStorage),
+	occupancyWords(OccupancyWords(width, height)), freeCellsListed(false), direction(SNAKE_UP), nextDirection(SNAKE_UP), growthPerEgg(1),
+	pendingGrowth(0), egg(-1), eggsEaten(0), alive(false), ticks(0), rng(1)
+{
+	freeCells.Attach(freeCellStorage, cellCount);
+}
+
+unsigned int SnakeSim::BodySize(int width, int height)
+{
+	unsigned int size = 1;
+	while (size < (unsigned int)(width * height))
+		size <<= 1;
+	return size;
+}
+
+//no snake anywhere and no free cell list
+void SnakeSim::clearGrid()
+{
+	for (unsigned int i = 0; i < occupancyWords; i++)
+		occupancy[i] = 0;
+	freeCellsListed = false;
+	//bits past the last cell count as taken so the egg search never lands there
+	if (cellCount & 63)
+		occupancy[occupancyWords - 1] = ~0ull << (cellCount & 63);
+}
+
+void SnakeSim::Reset(int x, int z, SnakeDirection direction, int length, uint64_t seed)
+{
+	clearGrid();
+
+	//laid out tail first so the head ends up in the newest slot
+	this->length = 0;
+	while ((unsigned int)length > mask + 1)
+		growBody(0);
+	headSlot = mask;
+	for (int i = length - 1; i >= 0; i--) {
+		int cell = (z - STEP_Z[direction] * i) * width + (x - STEP_X[direction] * i);
+		headSlot = (headSlot + 1) & mask;
+		body[headSlot] = cell;
+		occupy(cell);
+		this->length++;
+	}
+	headX = x;
+	headZ = z;
+
+	this->direction = direction;
+	nextDirection = direction;
+	pendingGrowth = 0;
+	eggsEaten = 0;
+	ticks = 0;
+	alive = true;
+	rng.Seed(seed);
+	placeEgg();
+}
+
+void SnakeSim::Turn(SnakeDirection direction)
+{
+	if (((direction + 2) & 3) != this->direction)
+		nextDirection = direction;
+}
+
+SnakeTickResult SnakeSim::Tick()
+{
+	if (!alive)
+		return SNAKE_DEAD;
+
+	direction = nextDirection;
+	int x = headX, z = headZ;
+	switch (direction) {
+	case SNAKE_UP: z--; break;
+	case SNAKE_RIGHT: x++; break;
+	case SNAKE_DOWN: z++; break;
+	case SNAKE_LEFT: x--; break;
+	}
+	ticks++;
+	if ((unsigned int)x >= (unsigned int)width || (unsigned int)z >= (unsigned int)height) {
+		alive = false;
+		return SNAKE_HIT_WALL;
+	}
+
+	//the tail leaves its cell this tick unless we're growing, so the head may move straight onto it. checked before
+	//growing so a snake that dies keeps the length and body it had
+	int tail = body[(headSlot - (length - 1)) & mask];
+	int cell = z * width + x;
+	if (Occupied(cell) && (cell != tail || pendingGrowth > 0)) {
+		alive = false;
+		return SNAKE_HIT_SELF;
+	}
+	if (pendingGrowth > 0) {
+		pendingGrowth--;
+		if ((unsigned int)length == mask + 1)
+			growBody(length);
+		length++;
+	}
+	else
+		vacate(tail);
+	headSlot = (headSlot + 1) & mask;
+	body[headSlot] = cell;
+	occupy(cell);
+	headX = x;
+	headZ = z;
+
+	if (cell != egg)
+		return SNAKE_MOVED;
+	eggsEaten++;
+	pendingGrowth += growthPerEgg;
+	placeEgg();
+	if (egg < 0) {
+		alive = false;
+		return SNAKE_FILLED;
+	}
+	return SNAKE_ATE;
+}
+
+//ticks, flags and counters as varints and the generator as it is, then the body as the head's cell and a 2 bit step
+//towards the tail for each other segment, four to a byte, and last the free cells in list order if they're listed
+void SnakeSim::WriteState(std::vector<unsigned char> &out) const
+{
+	WriteVarint(out, ticks);
+	WriteVarint(out, (alive ? 1 : 0) | (freeCellsListed ? 2 : 0));
+	WriteVarint(out, direction | nextDirection << 2);
+	WriteVarint(out, growthPerEgg);
+	WriteVarint(out, pendingGrowth);
+	WriteVarint(out, egg + 1);
+	WriteVarint(out, eggsEaten);
+	for (int i = 0; i < 4; i++)
+		WriteFixed64(out, rng.State(i));
+
+	WriteVarint(out, length);
+	WriteVarint(out, Segment(0));
+	unsigned char packed = 0;
+	for (int i = 1; i < length; i++) {
+		int from = Segment(i - 1), to = Segment(i);
+		int step = to == from - width ? SNAKE_UP : (to == from + 1 ? SNAKE_RIGHT : (to == from + width ? SNAKE_DOWN : SNAKE_LEFT));
+		packed |= step << (((i - 1) & 3) * 2);
+		if (((i - 1) & 3) == 3 || i == length - 1) {
+			out.push_back(packed);
+			packed = 0;
+		}
+	}
+
+	if (freeCellsListed) {
+		for (int i = 0; i < freeCells.Count(); i++)
+			WriteVarint(out, freeCells.Cell(i));
+	}
+}
+
+bool SnakeSim::ReadState(const unsigned char* &data, const unsigned char* end)
+{
+	alive = false;
+	uint64_t readTicks, state[4];
+	int flags, directions, readGrowth, readPending, readEgg, readEaten, readLength, head;
+	if (!ReadVarint(data, end, readTicks) || !ReadVarint(data, end, flags, 3) || !ReadVarint(data, end, directions, 15)
+		|| !ReadVarint(data, end, readGrowth, INT_MAX) || !ReadVarint(data, end, readPending, INT_MAX) || !ReadVarint(data, end, readEgg, cellCount)
+		|| !ReadVarint(data, end, readEaten, INT_MAX))
+		return false;
+	for (int i = 0; i < 4; i++) {
+		if (!ReadFixed64(data, end, state[i]))
+			return false;
+	}
+	if (!ReadVarint(data, end, readLength, cellCount) || readLength < 1 || !ReadVarint(data, end, head, cellCount - 1))
+		return false;
+
+	//the body straight into the ring, head in slot length - 1 and the tail in slot 0
+	clearGrid();
+	length = 0;
+	while ((unsigned int)readLength > mask + 1)
+		growBody(0);
+	headSlot = (unsigned int)(readLength - 1);
+	int x = head % width, z = head / width;
+	for (int i = 0; i < readLength; i++) {
+		if (i > 0) {
+			if (data >= end)
+				return false;
+			int step = (*data >> (((i - 1) & 3) * 2)) & 3;
+			if (((i - 1) & 3) == 3 || i == readLength - 1)
+				data++;
+			x += STEP_X[step];
+			z += STEP_Z[step];
+		}
+		int cell = z * width + x;
+		if ((unsigned int)x >= (unsigned int)width || (unsigned int)z >= (unsigned int)height || Occupied(cell))
+			return false;
+		body[(headSlot - i) & mask] = cell;
+		occupy(cell);
+		length++;
+	}
+
+	if (flags & 2) {
+		attachFreeCells();
+		std::vector<int> free(cellCount - length);
+		for (size_t i = 0; i < free.size(); i++) {
+			if (!ReadVarint(data, end, free[i], cellCount - 1) || Occupied(free[i]))
+				return false;
+		}
+		if (!freeCells.Assign(free.empty() ? NULL : &free[0], (int)free.size()))
+			return false;
+		freeCellsListed = true;
+	}
+
+	headX = head % width;
+	headZ = head / width;
+	ticks = readTicks;
+	direction = (SnakeDirection)(directions & 3);
+	nextDirection = (SnakeDirection)(directions >> 2);
+	growthPerEgg = readGrowth;
+	pendingGrowth = readPending;
+	egg = readEgg - 1;
+	eggsEaten = readEaten;
+	rng.SetState(state);
+	alive = (flags & 1) != 0;
+	return true;
+}
+
+//header, occupancy, body, free cells
+size_t SnakeSim::MaxSnapshotSize(int width, int height)
+{
+	return sizeof(SnakeSnapshotHeader) + OccupancyWords(width, height) * sizeof(uint64_t) + (size_t)width * height * sizeof(int) * 2;
+}
+
+size_t SnakeSim::SnapshotSize() const
+{
+	size_t freeCount = freeCellsListed ? (size_t)freeCells.Count() : 0;
+	return sizeof(SnakeSnapshotHeader) + occupancyWords * sizeof(uint64_t) + ((size_t)length + freeCount) * sizeof(int);
+}
+
+void SnakeSim::SaveSnapshot(unsigned char* out) const
+{
+	SnakeSnapshotHeader* header = (SnakeSnapshotHeader*)out;
+	memset(header, 0, sizeof(SnakeSnapshotHeader));
+	header->magic = SNAKE_SNAPSHOT_MAGIC;
+	header->version = SNAKE_SNAPSHOT_VERSION;
+	header->headerBytes = sizeof(SnakeSnapshotHeader);
+	header->totalBytes = (uint32_t)SnapshotSize();
+	header->width = width;
+	header->height = height;
+	header->ticks = ticks;
+	for (int i = 0; i < 4; i++)
+		header->rng[i] = rng.State(i);
+	header->length = length;
+	header->direction = direction;
+	header->nextDirection = nextDirection;
+	header->growthPerEgg = growthPerEgg;
+	header->pendingGrowth = pendingGrowth;
+	header->egg = egg;
+	header->eggsEaten = eggsEaten;
+	header->freeCount = freeCellsListed ? freeCells.Count() : -1;
+	header->alive = alive ? 1 : 0;
+	header->occupancyOffset = sizeof(SnakeSnapshotHeader);
+	header->occupancyWords = occupancyWords;
+	header->bodyOffset = header->occupancyOffset + occupancyWords * sizeof(uint64_t);
+	header->freeCellsOffset = header->bodyOffset + length * sizeof(int);
+
+	memcpy(out + header->occupancyOffset, occupancy, occupancyWords * sizeof(uint64_t));
+	//the ring from the tail round to the head, in at most two pieces
+	unsigned int tailSlot = (headSlot - (length - 1)) & mask;
+	unsigned int firstPiece = mask + 1 - tailSlot < (unsigned int)length ? mask + 1 - tailSlot : (unsigned int)length;
+	int* snapshotBody = (int*)(out + header->bodyOffset);
+	memcpy(snapshotBody, body + tailSlot, firstPiece * sizeof(int));
+	memcpy(snapshotBody + firstPiece, body, (length - firstPiece) * sizeof(int));
+	if (freeCellsListed) {
+		int* snapshotFree = (int*)(out + header->freeCellsOffset);
+		for (int i = 0; i < freeCells.Count(); i++)
+			snapshotFree[i] = freeCells.Cell(i);
+	}
+}
+
+//the header's numbers are checked before anything is read at an offset
+bool SnakeSim::LoadSnapshot(const unsigned char* data, size_t size)
+{
+	alive = false;
+	const SnakeSnapshotHeader* header = (const SnakeSnapshotHeader*)data;
+	if (size < sizeof(SnakeSnapshotHeader) || header->magic != SNAKE_SNAPSHOT_MAGIC || header->version != SNAKE_SNAPSHOT_VERSION
+		|| header->headerBytes < sizeof(SnakeSnapshotHeader) || header->totalBytes > size || header->width != width || header->height != height)
+		return false;
+	if (header->length < 1 || header->length > cellCount || (header->freeCount >= 0 && header->freeCount != cellCount - header->length)
+		|| (unsigned int)header->direction > SNAKE_LEFT || (unsigned int)header->nextDirection > SNAKE_LEFT
+		|| header->egg < -1 || header->egg >= cellCount || header->occupancyWords != occupancyWords || (header->occupancyOffset & 7))
+		return false;
+	size_t freeCount = header->freeCount >= 0 ? (size_t)header->freeCount : 0;
+	if ((uint64_t)header->occupancyOffset + occupancyWords * sizeof(uint64_t) > header->totalBytes
+		|| (uint64_t)header->bodyOffset + (size_t)header->length * sizeof(int) > header->totalBytes
+		|| (uint64_t)header->freeCellsOffset + freeCount * sizeof(int) > header->totalBytes || ((header->bodyOffset | header->freeCellsOffset) & 3))
+		return false;
+
+	//the bitset has to be the body's cells and the bits past the grid, nothing else, or placing an egg could
+	//search forever
+	const int* snapshotBody = (const int*)(data + header->bodyOffset);
+	const uint64_t* snapshotOccupancy = (const uint64_t*)(data + header->occupancyOffset);
+	for (int i = 0; i < header->length; i++) {
+		int cell = snapshotBody[i];
+		if ((unsigned int)cell >= (unsigned int)cellCount || !((snapshotOccupancy[cell >> 6] >> (cell & 63)) & 1))
+			return false;
+	}
+	size_t bits = 0;
+	for (unsigned int i = 0; i < occupancyWords; i++)
+		bits += std::bitset<64>(snapshotOccupancy[i]).count();
+	if (bits != (size_t)header->length + (occupancyWords * 64 - cellCount))
+		return false;
+	//and the listed free cells have to be clear in it, or an egg could land on the snake
+	const int* snapshotFree = (const int*)(data + header->freeCellsOffset);
+	for (size_t i = 0; i < freeCount; i++) {
+		int cell = snapshotFree[i];
+		if ((unsigned int)cell >= (unsigned int)cellCount || ((snapshotOccupancy[cell >> 6] >> (cell & 63)) & 1))
+			return false;
+	}
+	while ((unsigned int)header->length > mask + 1)
+		growBody(0);
+	if (header->freeCount >= 0) {
+		attachFreeCells();
+		if (!freeCells.Assign(snapshotFree, header->freeCount))
+			return false;
+	}
+	freeCellsListed = header->freeCount >= 0;
+	memcpy(occupancy, snapshotOccupancy, occupancyWords * sizeof(uint64_t));
+	memcpy(body, snapshotBody, header->length * sizeof(int));
+	length = header->length;
+	headSlot = (unsigned int)(length - 1);
+	headX = body[headSlot] % width;
+	headZ = body[headSlot] / width;
+
+	ticks = header->ticks;
+	rng.SetState(header->rng);
+	direction = (SnakeDirection)header->direction;
+	nextDirection = (SnakeDirection)header->nextDirection;
+	growthPerEgg = header->growthPerEgg;
+	pendingGrowth = header->pendingGrowth;
+	egg = header->egg;
+	eggsEaten = header->eggsEaten;
+	alive = header->alive != 0;
+	return true;
+}
+
+//twice the ring buffer, keeping the newest segments (tail first from slot 0, so the head is at segments - 1).
+//only ever needed when the game owns its buffer, one the caller gave is big enough for the whole grid
+void SnakeSim::growBody(int segments)
+{
+	std::vector<int> grown((size_t)(mask + 1) * 2);
+	for (int i = 0; i < segments; i++)
+		grown[i] = body[(headSlot - (segments - 1 - i)) & mask];
+	ownedBody.swap(grown);
+	body = &ownedBody[0];
+	mask = (unsigned int)ownedBody.size() - 1;
+	headSlot = (unsigned int)(segments - 1) & mask;
+}
+
+//a game that owns its storage only allocates the free cell list once it's first needed, most games on a big grid
+//never get that far
+void SnakeSim::attachFreeCells()
+{
+	if (freeCells.Attached())
+		return;
+	ownedFreeCells.resize(FreeCellsSize(width, height));
+	freeCells.Attach(&ownedFreeCells[0], cellCount);
+}
+
+//any free cell with the same chance. while at least half the grid is free a guess lands on one at least every other
+//try; after that the free cells are listed once and the list kept up to date until the next Reset, so each egg is
+//one draw from it
+void SnakeSim::placeEgg()
+{
+	egg = -1;
+	if (length >= cellCount)
+		return;
+	if (!freeCellsListed && (cellCount - length) * 2 < cellCount) {
+		attachFreeCells();
+		freeCells.Reset();
+		for (int i = 0; i < length; i++)
+			freeCells.Take(Segment(i));
+		freeCellsListed = true;
+	}
+	if (freeCellsListed) {
+		egg = freeCells.Sample(rng);
+		return;
+	}
+	do
+		egg = (int)rng.Below((uint32_t)cellCount);
+	while (Occupied(egg));
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SnakeRandom.h"
+
+// which way the head moves, up is -z like the arrow keys in the game
+enum SnakeDirection {
+	SNAKE_UP,
+	SNAKE_RIGHT,
+	SNAKE_DOWN,
+	SNAKE_LEFT
+};
+
+enum SnakeTickResult {
+	SNAKE_MOVED,
+	SNAKE_ATE,		// moved onto the egg, the snake grows over the next ticks
+	SNAKE_HIT_WALL,
+	SNAKE_HIT_SELF,
+	SNAKE_FILLED,	// ate the last egg there was room for
+	SNAKE_DEAD		// ticked after the game ended, nothing happens
+};
+
+// The rules of the game on a grid of cells, with nothing to do with windows or drawing, so it can run headless
+// as fast as a core allows. The body is a ring buffer of cell indices (head at the front) that doubles when the
+// snake outgrows it, so moving and growing are O(1) and only a handful of ticks in a game allocate, and a huge
+// grid doesn't cost a ring buffer the size of the grid. A bitset with one bit per cell answers "is there snake
+// here" in O(1) for self collision and egg placement. Once the snake covers half the grid a FreeCellList of the
+// cells without snake takes over placing the egg, so it stays one draw however full the grid gets. All
+// randomness comes from one seeded SnakeRandom, so the same seed and the same turns play out the same game on
+// any machine.
+// Cells are indexed z * width + x.
+// The ring buffer, bitset and free cell list can live in memory the caller owns (BodySize / OccupancyWords /
+// FreeCellsSize long, the ring then never needs to grow), so a batch of games can keep all of them in one
+// contiguous block each.
+class SnakeSim
+{
+public:
+	SnakeSim(int width, int height);
+	SnakeSim(int width, int height, int* bodyStorage, uint64_t* occupancyStorage, int* freeCellStorage);
+	SnakeSim(SnakeSim &&other) = default;
+	// copies would still point at the original's buffers
+	SnakeSim(const SnakeSim &) = delete;
+	SnakeSim &operator=(const SnakeSim &) = delete;
+
+	// ints of ring buffer, 64 bit words of bitset and ints of free cell list a game on this grid needs
+	static unsigned int BodySize(int width, int height);
+	static unsigned int OccupancyWords(int width, int height) { return (unsigned int)(width * height + 63) / 64; }
+	static unsigned int FreeCellsSize(int width, int height) { return FreeCellList::StorageSize(width * height); }
+
+	// a fresh game: a straight snake of length cells with its head at (x, z) facing direction (the rest of it
+	// trailing behind, it must fit on the grid), and an egg somewhere free. seed picks where the eggs go
+	void Reset(int x, int z, SnakeDirection direction, int length, uint64_t seed);
+
+	// the direction the head takes next tick, turning straight back into the neck is ignored
+	void Turn(SnakeDirection direction);
+	SnakeTickResult Tick();
+
+	// the whole game in a few bytes (varints, the body as 2 bit steps), enough to carry on exactly where it left
+	// off, the free cell list's order and the generator included
+	void WriteState(std::vector<unsigned char> &out) const;
+	// a game written by WriteState on a grid this size. false if the data is cut short or doesn't make sense,
+	// the game is left dead then
+	bool ReadState(const unsigned char* &data, const unsigned char* end);
+
+	// the whole game as one flat blob (SnakeSnapshotHeader and the arrays as they are) for quick saves and rewinding:
+	// bigger than WriteState but only a few memcpys either way
+	static size_t MaxSnapshotSize(int width, int height);
+	size_t SnapshotSize() const;
+	// writes SnapshotSize() bytes, out 8 byte aligned
+	void SaveSnapshot(unsigned char* out) const;
+	// a snapshot of a game on a grid this size, data 8 byte aligned. false if it isn't one or doesn't add up, the
+	// game is left dead then. only allocates when the snake is longer than this game's ring buffer has been so far
+	bool LoadSnapshot(const unsigned char* data, size_t size);
+
+	// cells the snake grows by for every egg eaten
+	void SetGrowthPerEgg(int cells) { growthPerEgg = cells; }
+	int GrowthPerEgg() const { return growthPerEgg; }
+	// ticks left in which the tail stays put
+	int PendingGrowth() const { return pendingGrowth; }
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+	bool Alive() const { return alive; }
+	SnakeDirection Direction() const { return direction; }
+	SnakeDirection NextDirection() const { return nextDirection; }
+	int Length() const { return length; }
+	int Score() const { return eggsEaten; }
+	unsigned long long Ticks() const { return ticks; }
+
+	// segment 0 is the head, Length() - 1 the tail
+	int Segment(int i) const { return body[(headSlot - i) & mask]; }
+	int HeadX() const { return headX; }
+	int HeadZ() const { return headZ; }
+	// cell of the egg, -1 when the snake fills the grid
+	int Egg() const { return egg; }
+
+	bool Occupied(int cell) const { return (occupancy[cell >> 6] >> (cell & 63)) & 1; }
+	bool Occupied(int x, int z) const { return Occupied(z * width + x); }
+	// the bitset itself, bits past the last cell are set
+	const uint64_t* Occupancy() const { return occupancy; }
+
+private:
+	int width, height;
+	int cellCount;
+
+	int* body;	// ring buffer, a power of two in size, never more than BodySize
+	unsigned int mask;
+	unsigned int headSlot;
+	int length;
+	int headX, headZ;
+
+	uint64_t* occupancy;
+	unsigned int occupancyWords;
+	FreeCellList freeCells;
+	bool freeCellsListed;	// the list is only kept up to date from when the snake covers half the grid
+
+	// storage when the caller didn't provide any
+	std::vector<int> ownedBody;
+	std::vector<uint64_t> ownedOccupancy;
+	std::vector<int> ownedFreeCells;	// empty until the free cells are first listed
+
+	SnakeDirection direction;	// the way the head went last tick
+	SnakeDirection nextDirection;
+	int growthPerEgg;
+	int pendingGrowth;
+	int egg;
+	int eggsEaten;
+	bool alive;
+	unsigned long long ticks;
+	SnakeRandom rng;
+
+	void clearGrid();
+	void growBody(int segments);
+	void attachFreeCells();
+	void occupy(int cell)
+	{
+		occupancy[cell >> 6] |= 1ull << (cell & 63);
+		if (freeCellsListed)
+			freeCells.Take(cell);
+	}
+	void vacate(int cell)
+	{
+		occupancy[cell >> 6] &= ~(1ull << (cell & 63));
+		if (freeCellsListed)
+			freeCells.Release(cell);
+	}
+	void placeEgg();
+};
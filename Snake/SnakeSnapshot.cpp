@@ -0,0 +1,29 @@
+#include "SnakeSnapshot.h"
+
+SnakeRewind::SnakeRewind(int width, int height, unsigned int capacity) : slotBytes((SnakeSim::MaxSnapshotSize(width, height) + 7) & ~(size_t)7),
+	capacity(capacity > 0 ? capacity : 1), newest(0), count(0)
+{
+	slots.resize(slotBytes * this->capacity);
+	sizes.resize(this->capacity);
+}
+
+void SnakeRewind::Push(const SnakeSim &sim)
+{
+	newest = (newest + 1) % capacity;
+	sim.SaveSnapshot(&slots[newest * slotBytes]);
+	sizes[newest] = sim.SnapshotSize();
+	if (count < capacity)
+		count++;
+}
+
+bool SnakeRewind::Rewind(SnakeSim &sim, unsigned int steps)
+{
+	if (steps >= count)
+		return false;
+	size_t slot = slotOf(steps);
+	if (!sim.LoadSnapshot(&slots[slot * slotBytes], sizes[slot]))
+		return false;
+	newest = (unsigned int)slot;
+	count -= steps;
+	return true;
+}
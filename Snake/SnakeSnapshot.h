@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SnakeSim.h"
+
+// "SNSS" read as a little endian word
+const uint32_t SNAKE_SNAPSHOT_MAGIC = 0x53534E53;
+const uint32_t SNAKE_SNAPSHOT_VERSION = 1;
+
+// A SnakeSim snapshot is this header followed by plain arrays at the offsets it gives (from the start of the blob,
+// so the blob can be copied, written out or mapped anywhere): the occupancy bitset, the body tail first and, when
+// the game keeps one, the free cell list in list order. Only fixed width fields, in the machine's byte order, no
+// padding the compiler picks. Reading a newer header (headerBytes bigger) works as long as the version matches.
+struct SnakeSnapshotHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerBytes;
+	uint32_t totalBytes;
+	int32_t width, height;
+	uint64_t ticks;
+	uint64_t rng[4];
+	int32_t length;
+	int32_t direction, nextDirection;
+	int32_t growthPerEgg, pendingGrowth;
+	int32_t egg;
+	int32_t eggsEaten;
+	int32_t freeCount;	// -1 when the free cells aren't listed
+	uint8_t alive;
+	uint8_t unused[3];
+	uint32_t occupancyOffset, occupancyWords;
+	uint32_t bodyOffset;		// length ints
+	uint32_t freeCellsOffset;	// freeCount ints
+	uint32_t reserved;
+};
+static_assert(sizeof(SnakeSnapshotHeader) == 120 && sizeof(SnakeSnapshotHeader) % 8 == 0, "snapshot header must keep its layout");
+
+// The last few hundred states of a game for rewinding or undo. Every slot is as big as the largest snapshot the grid
+// can have and they're all allocated up front, so pushing one a tick is a couple of memcpys and never allocates.
+// Once full, a push drops the oldest.
+class SnakeRewind
+{
+public:
+	SnakeRewind(int width, int height, unsigned int capacity);
+
+	void Push(const SnakeSim &sim);
+	// puts sim back to the state steps pushes ago (0 is the newest) and forgets the newer ones, so it can be pushed
+	// on from there. false when there aren't that many
+	bool Rewind(SnakeSim &sim, unsigned int steps);
+	void Clear() { count = 0; }
+
+	unsigned int Count() const { return count; }
+	unsigned int Capacity() const { return capacity; }
+	// a stored snapshot, 0 the newest, SnapshotBytes(steps) long
+	const unsigned char* Snapshot(unsigned int steps) const { return &slots[slotOf(steps) * slotBytes]; }
+	size_t SnapshotBytes(unsigned int steps) const { return sizes[slotOf(steps)]; }
+
+private:
+	size_t slotBytes;
+	unsigned int capacity;
+	unsigned int newest;	// slot of the newest snapshot
+	unsigned int count;
+	std::vector<unsigned char> slots;
+	std::vector<size_t> sizes;
+
+	size_t slotOf(unsigned int steps) const { return (newest + capacity - steps) % capacity; }
+};
@@ -0,0 +1,128 @@
+#include "SpatialGrid.h"
+
+#include <cmath>
+
+const int SpatialGrid::NONE;
+const int SpatialGrid::BLOCK_SHIFT;
+const int SpatialGrid::BLOCK_CELLS;
+
+SpatialGrid::SpatialGrid(float minX, float minZ, float maxX, float maxZ, float cellSize) : count(0)
+{
+	Reset(minX, minZ, maxX, maxZ, cellSize);
+}
+
+void SpatialGrid::Reset(float minX, float minZ, float maxX, float maxZ, float cellSize)
+{
+	this->minX = minX;
+	this->minZ = minZ;
+	this->cellSize = cellSize;
+	inverseCellSize = 1.0f / cellSize;
+	columns = (int)std::ceil((maxX - minX) * inverseCellSize);
+	rows = (int)std::ceil((maxZ - minZ) * inverseCellSize);
+	if (columns < 1)
+		columns = 1;
+	if (rows < 1)
+		rows = 1;
+	blocksX = (columns + BLOCK_CELLS - 1) >> BLOCK_SHIFT;
+	blocksZ = (rows + BLOCK_CELLS - 1) >> BLOCK_SHIFT;
+	Clear();
+}
+
+int SpatialGrid::Insert(float x, float z, unsigned int data)
+{
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else {
+		id = (int)cell.size();
+		posX.push_back(0.0f);
+		posZ.push_back(0.0f);
+		cell.push_back(NONE);
+		next.push_back(NONE);
+		prev.push_back(NONE);
+		userData.push_back(0);
+	}
+
+	posX[id] = x;
+	posZ[id] = z;
+	userData[id] = data;
+	link(id, slot(column(x), row(z)));
+	count++;
+	return id;
+}
+
+void SpatialGrid::Move(int id, float x, float z)
+{
+	posX[id] = x;
+	posZ[id] = z;
+	//most moves stay inside the same cell and are just the two stores above
+	int c = slot(column(x), row(z));
+	if (c == cell[id])
+		return;
+	unlink(id);
+	link(id, c);
+}
+
+void SpatialGrid::Remove(int id)
+{
+	if (cell[id] == NONE)
+		return;
+	unlink(id);
+	cell[id] = NONE;
+	freeIds.push_back(id);
+	count--;
+}
+
+void SpatialGrid::Clear()
+{
+	blocks.assign(blocksX * blocksZ, NONE);
+	cellHead.clear();
+	posX.clear();
+	posZ.clear();
+	cell.clear();
+	next.clear();
+	prev.clear();
+	userData.clear();
+	freeIds.clear();
+	count = 0;
+}
+
+unsigned int SpatialGrid::Query(float x, float z, float radius, std::vector<int> &out) const
+{
+	size_t before = out.size();
+	ForEachNear(x, z, radius, [&out](int id) { out.push_back(id); });
+	return (unsigned int)(out.size() - before);
+}
+
+//where a cell's list head lives, allocating its block if this is the first time anything goes in it
+int SpatialGrid::slot(int column, int row)
+{
+	int &block = blocks[(row >> BLOCK_SHIFT) * blocksX + (column >> BLOCK_SHIFT)];
+	if (block == NONE) {
+		block = (int)cellHead.size();
+		cellHead.resize(cellHead.size() + BLOCK_CELLS * BLOCK_CELLS, NONE);
+	}
+	return block + ((row & (BLOCK_CELLS - 1)) << BLOCK_SHIFT) + (column & (BLOCK_CELLS - 1));
+}
+
+void SpatialGrid::link(int id, int c)
+{
+	cell[id] = c;
+	prev[id] = NONE;
+	next[id] = cellHead[c];
+	if (cellHead[c] != NONE)
+		prev[cellHead[c]] = id;
+	cellHead[c] = id;
+}
+
+void SpatialGrid::unlink(int id)
+{
+	if (prev[id] != NONE)
+		next[prev[id]] = next[id];
+	else
+		cellHead[cell[id]] = next[id];
+	if (next[id] != NONE)
+		prev[next[id]] = prev[id];
+}
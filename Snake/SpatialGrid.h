@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Uniform grid over a rectangle of the XZ plane for finding what is near what without checking every pair.
+// Each cell keeps an intrusive doubly linked list of the entities in it, so insert, move and remove are O(1)
+// and a neighbour query only looks at the cells its circle overlaps. Pick the cell size about the diameter of
+// the things being stored, then a query for anything touching an entity only has to visit a 3x3 block.
+// Positions outside the rectangle are clamped into the border cells.
+// The cells' list heads are allocated in square blocks the first time something enters one, so a huge arena
+// with everything in one corner only pays for the corner.
+class SpatialGrid
+{
+public:
+	static const int NONE = -1;
+
+	SpatialGrid(float minX, float minZ, float maxX, float maxZ, float cellSize);
+
+	// a new rectangle, everything is removed
+	void Reset(float minX, float minZ, float maxX, float maxZ, float cellSize);
+
+	// returns the entity's id, ids of removed entities get reused
+	int Insert(float x, float z, unsigned int userData = 0);
+	void Move(int id, float x, float z);
+	void Remove(int id);
+	void Clear();
+
+	float X(int id) const { return posX[id]; }
+	float Z(int id) const { return posZ[id]; }
+	unsigned int UserData(int id) const { return userData[id]; }
+	size_t Count() const { return count; }
+	// cell blocks allocated so far, they stay until Reset
+	size_t Blocks() const { return cellHead.size() / (BLOCK_CELLS * BLOCK_CELLS); }
+
+	// calls visit(id) for every entity within radius of (x, z)
+	template<typename Visitor>
+	void ForEachNear(float x, float z, float radius, const Visitor &visit) const;
+	// appends the ids within radius of (x, z) to out, returns how many were found
+	unsigned int Query(float x, float z, float radius, std::vector<int> &out) const;
+
+private:
+	// cells along each side of a block
+	static const int BLOCK_SHIFT = 4;
+	static const int BLOCK_CELLS = 1 << BLOCK_SHIFT;
+
+	float minX, minZ;
+	float cellSize, inverseCellSize;
+	int columns, rows;
+	int blocksX, blocksZ;
+	std::vector<int> blocks;	// first cellHead slot of each block, NONE until something goes in it
+	std::vector<int> cellHead;	// first entity in each cell, a block's cells together in rows
+
+	// per entity
+	std::vector<float> posX, posZ;
+	std::vector<int> cell; // cellHead slot, NONE when the id is free
+	std::vector<int> next, prev;
+	std::vector<unsigned int> userData;
+	std::vector<int> freeIds;
+	size_t count;
+
+	int column(float x) const;
+	int row(float z) const;
+	int slot(int column, int row);
+	void link(int id, int c);
+	void unlink(int id);
+};
+
+inline int SpatialGrid::column(float x) const
+{
+	int c = (int)((x - minX) * inverseCellSize);
+	return c < 0 ? 0 : (c >= columns ? columns - 1 : c);
+}
+
+inline int SpatialGrid::row(float z) const
+{
+	int r = (int)((z - minZ) * inverseCellSize);
+	return r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+}
+
+template<typename Visitor>
+void SpatialGrid::ForEachNear(float x, float z, float radius, const Visitor &visit) const
+{
+	int firstColumn = column(x - radius), lastColumn = column(x + radius);
+	int firstRow = row(z - radius), lastRow = row(z + radius);
+	float radiusSquared = radius * radius;
+
+	for (int r = firstRow; r <= lastRow; r++) {
+		for (int c = firstColumn; c <= lastColumn; c++) {
+			int block = blocks[(r >> BLOCK_SHIFT) * blocksX + (c >> BLOCK_SHIFT)];
+			if (block == NONE)
+				continue;
+			for (int id = cellHead[block + ((r & (BLOCK_CELLS - 1)) << BLOCK_SHIFT) + (c & (BLOCK_CELLS - 1))]; id != NONE; id = next[id]) {
+				float dx = posX[id] - x, dz = posZ[id] - z;
+				if (dx * dx + dz * dz <= radiusSquared)
+					visit(id);
+			}
+		}
+	}
+}
@@ -0,0 +1,193 @@
+#include "TransformStore.h"
+
+#include "JobSystem.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+//entities per job when the update is spread over the job system
+const unsigned int UPDATE_GRAIN = 1024;
+
+unsigned int TransformStore::Create(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale, int parentId)
+{
+	unsigned int id = (unsigned int)parent.size();
+	px.push_back(position.x);
+	py.push_back(position.y);
+	pz.push_back(position.z);
+	qx.push_back(rotation.x);
+	qy.push_back(rotation.y);
+	qz.push_back(rotation.z);
+	qw.push_back(rotation.w);
+	sx.push_back(scale.x);
+	sy.push_back(scale.y);
+	sz.push_back(scale.z);
+	//parents have to come first, anything else would break the single forward pass
+	if (parentId >= (int)id)
+		parentId = NO_PARENT;
+	parent.push_back(parentId);
+	dirty.push_back(1);
+	hasChildren.push_back(0);
+	world.push_back(glm::mat4(1.0f));
+	if (parentId != NO_PARENT) {
+		hasChildren[parentId] = 1;
+		anyParented = true;
+	}
+	return id;
+}
+
+void TransformStore::Reserve(size_t count)
+{
+	px.reserve(count); py.reserve(count); pz.reserve(count);
+	qx.reserve(count); qy.reserve(count); qz.reserve(count); qw.reserve(count);
+	sx.reserve(count); sy.reserve(count); sz.reserve(count);
+	parent.reserve(count);
+	dirty.reserve(count);
+	hasChildren.reserve(count);
+	world.reserve(count);
+}
+
+void TransformStore::Clear()
+{
+	px.clear(); py.clear(); pz.clear();
+	qx.clear(); qy.clear(); qz.clear(); qw.clear();
+	sx.clear(); sy.clear(); sz.clear();
+	parent.clear();
+	dirty.clear();
+	hasChildren.clear();
+	world.clear();
+	anyParented = false;
+}
+
+void TransformStore::SetPosition(unsigned int id, const glm::vec3 &position)
+{
+	px[id] = position.x;
+	py[id] = position.y;
+	pz[id] = position.z;
+	dirty[id] = 1;
+}
+
+void TransformStore::SetRotation(unsigned int id, const glm::quat &rotation)
+{
+	qx[id] = rotation.x;
+	qy[id] = rotation.y;
+	qz[id] = rotation.z;
+	qw[id] = rotation.w;
+	dirty[id] = 1;
+}
+
+void TransformStore::SetScale(unsigned int id, const glm::vec3 &scale)
+{
+	sx[id] = scale.x;
+	sy[id] = scale.y;
+	sz[id] = scale.z;
+	dirty[id] = 1;
+}
+
+void TransformStore::Update(JobSystem* jobs)
+{
+	unsigned int count = (unsigned int)Count();
+	if (count == 0)
+		return;
+
+	//a dirty parent dirties its whole subtree, parents come first so one forward sweep is enough
+	if (anyParented) {
+		for (unsigned int i = 0; i < count; i++) {
+			if (parent[i] != NO_PARENT && dirty[parent[i]])
+				dirty[i] = 1;
+		}
+	}
+
+	//local matrices (translate * rotate * scale) don't depend on each other, so this part runs in parallel
+	if (jobs && count > UPDATE_GRAIN)
+		jobs->ParallelFor(0, count, UPDATE_GRAIN, [this](unsigned int first, unsigned int last) { composeLocal(first, last); });
+	else
+		composeLocal(0, count);
+
+	//then bring children into their parent's space, in order
+	if (anyParented) {
+		for (unsigned int i = 0; i < count; i++) {
+			if (parent[i] != NO_PARENT && dirty[i])
+				world[i] = world[parent[i]] * world[i];
+		}
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+		dirty[i] = 0;
+}
+
+//translate * rotate * scale for one entity
+void TransformStore::composeLocalScalar(unsigned int i)
+{
+	float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+	float xx = x * x, yy = y * y, zz = z * z;
+	float xy = x * y, xz = x * z, yz = y * z;
+	float wx = w * x, wy = w * y, wz = w * z;
+
+	glm::mat4 &m = world[i];
+	m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * sx[i], 2.0f * (xy + wz) * sx[i], 2.0f * (xz - wy) * sx[i], 0.0f);
+	m[1] = glm::vec4(2.0f * (xy - wz) * sy[i], (1.0f - 2.0f * (xx + zz)) * sy[i], 2.0f * (yz + wx) * sy[i], 0.0f);
+	m[2] = glm::vec4(2.0f * (xz + wy) * sz[i], 2.0f * (yz - wx) * sz[i], (1.0f - 2.0f * (xx + yy)) * sz[i], 0.0f);
+	m[3] = glm::vec4(px[i], py[i], pz[i], 1.0f);
+}
+
+void TransformStore::composeLocal(unsigned int first, unsigned int last)
+{
+	unsigned int i = first;
+
+#ifdef TRANSFORM_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= last; i += 4) {
+		//skip whole groups of four that nothing touched. the others get all four local matrices stored, so all four
+		//are dirty now and the parent pass puts the clean ones back in their parent's space too
+		if (!(dirty[i] | dirty[i + 1] | dirty[i + 2] | dirty[i + 3]))
+			continue;
+		dirty[i] = dirty[i + 1] = dirty[i + 2] = dirty[i + 3] = 1;
+
+		__m128 x = _mm_loadu_ps(&qx[i]), y = _mm_loadu_ps(&qy[i]), z = _mm_loadu_ps(&qz[i]), w = _mm_loadu_ps(&qw[i]);
+		__m128 scaleX = _mm_loadu_ps(&sx[i]), scaleY = _mm_loadu_ps(&sy[i]), scaleZ = _mm_loadu_ps(&sz[i]);
+
+		__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+		//every register holds one matrix element for four entities: mRC = row R of column C
+		__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX);
+		__m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX);
+		__m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX);
+
+		__m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY);
+		__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY);
+		__m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY);
+
+		__m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ);
+		__m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ);
+		__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ);
+
+		__m128 m03 = _mm_loadu_ps(&px[i]), m13 = _mm_loadu_ps(&py[i]), m23 = _mm_loadu_ps(&pz[i]);
+		__m128 w0 = zero, w1 = zero, w2 = zero, w3 = one;
+
+		//transpose each column from "one element, four entities" to "four elements, one entity"
+		_MM_TRANSPOSE4_PS(m00, m10, m20, w0);
+		_MM_TRANSPOSE4_PS(m01, m11, m21, w1);
+		_MM_TRANSPOSE4_PS(m02, m12, m22, w2);
+		_MM_TRANSPOSE4_PS(m03, m13, m23, w3);
+
+		float* out = &world[i][0][0];
+		_mm_storeu_ps(out + 0, m00);  _mm_storeu_ps(out + 4, m01);  _mm_storeu_ps(out + 8, m02);  _mm_storeu_ps(out + 12, m03);
+		_mm_storeu_ps(out + 16, m10); _mm_storeu_ps(out + 20, m11); _mm_storeu_ps(out + 24, m12); _mm_storeu_ps(out + 28, m13);
+		_mm_storeu_ps(out + 32, m20); _mm_storeu_ps(out + 36, m21); _mm_storeu_ps(out + 40, m22); _mm_storeu_ps(out + 44, m23);
+		_mm_storeu_ps(out + 48, w0);  _mm_storeu_ps(out + 52, w1);  _mm_storeu_ps(out + 56, w2);  _mm_storeu_ps(out + 60, w3);
+	}
+#endif
+
+	//leftovers (or everything without SSE)
+	for (; i < last; i++) {
+		if (dirty[i])
+			composeLocalScalar(i);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+class JobSystem;
+
+// Transform components for many entities, stored structure-of-arrays (one array per component) so world
+// matrices can be composed four entities at a time with SSE. Entities are plain indices handed out by Create.
+// A parent always has to be created before its children, then a single forward pass over the arrays sees every
+// parent's world matrix before its children need it. Only entities marked dirty (or under a dirty parent) get
+// recomputed in Update. The world matrices sit in one contiguous array, ready to be copied into an instance buffer.
+class TransformStore
+{
+public:
+	static const int NO_PARENT = -1;
+
+	TransformStore() : anyParented(false) {}
+
+	unsigned int Create(const glm::vec3 &position = glm::vec3(0.0f), const glm::quat &rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+		const glm::vec3 &scale = glm::vec3(1.0f), int parent = NO_PARENT);
+	void Reserve(size_t count);
+	void Clear();
+
+	void SetPosition(unsigned int id, const glm::vec3 &position);
+	void SetRotation(unsigned int id, const glm::quat &rotation);
+	void SetScale(unsigned int id, const glm::vec3 &scale);
+
+	glm::vec3 GetPosition(unsigned int id) const { return glm::vec3(px[id], py[id], pz[id]); }
+
+	// recomputes the world matrix of every dirty entity, spreading the work over the job system when given one
+	void Update(JobSystem* jobs = NULL);
+
+	size_t Count() const { return parent.size(); }
+	const glm::mat4 &World(unsigned int id) const { return world[id]; }
+	const glm::mat4* WorldMatrices() const { return world.empty() ? NULL : &world[0]; }
+
+private:
+	std::vector<float> px, py, pz;		// position
+	std::vector<float> qx, qy, qz, qw;	// rotation quaternion
+	std::vector<float> sx, sy, sz;		// scale
+	std::vector<int> parent;
+	std::vector<unsigned char> dirty;
+	std::vector<unsigned char> hasChildren;
+	std::vector<glm::mat4> world;
+	bool anyParented;
+
+	void composeLocal(unsigned int first, unsigned int last);
+	void composeLocalScalar(unsigned int i);
+};
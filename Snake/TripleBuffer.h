@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Lock free hand-off of whole objects from one producer thread to one consumer thread.
+// There are three copies of T: the producer always owns one to write into, the consumer always owns one to
+// read from, and the third sits in the middle holding the newest published copy. Publishing and acquiring
+// just swap indices with the middle slot, so neither side ever waits for the other or sees a half written T.
+// If the producer publishes faster than the consumer reads, the stale copies are simply overwritten.
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : state(1), writeIndex(0), readIndex(2), interrupted(false) {}
+
+	// producer side: fill this in completely, then Publish
+	T &WriteBuffer() { return buffers[writeIndex]; }
+
+	void Publish()
+	{
+		unsigned int previous = state.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+		writeIndex = previous & INDEX_MASK;
+		//the lock only orders us against a consumer that is about to sleep, it is never held while copying
+		{
+			std::lock_guard<std::mutex> lock(waitMutex);
+		}
+		wakeUp.notify_one();
+	}
+
+	// consumer side: swaps in the newest published copy, returns false if nothing new was published
+	bool Acquire()
+	{
+		if (!(state.load(std::memory_order_acquire) & FRESH_BIT))
+			return false;
+		unsigned int previous = state.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previous & INDEX_MASK;
+		return true;
+	}
+
+	const T &ReadBuffer() const { return buffers[readIndex]; }
+
+	// blocks the consumer until something is published, Interrupt is called or the timeout runs out
+	bool WaitForNew(double timeoutSeconds)
+	{
+		std::unique_lock<std::mutex> lock(waitMutex);
+		return wakeUp.wait_for(lock, std::chrono::duration<double>(timeoutSeconds), [this] {
+			return (state.load(std::memory_order_acquire) & FRESH_BIT) != 0 || interrupted.load();
+		});
+	}
+
+	// wakes a waiting consumer without publishing, used for shutdown
+	void Interrupt()
+	{
+		{
+			std::lock_guard<std::mutex> lock(waitMutex);
+			interrupted = true;
+		}
+		wakeUp.notify_all();
+	}
+
+private:
+	static const unsigned int INDEX_MASK = 3;
+	static const unsigned int FRESH_BIT = 4;
+
+	T buffers[3];
+	std::atomic<unsigned int> state;	// index of the middle slot plus FRESH_BIT when it holds an unread copy
+	unsigned int writeIndex;			// producer thread only
+	unsigned int readIndex;				// consumer thread only
+
+	std::mutex waitMutex;
+	std::condition_variable wakeUp;
+	std::atomic<bool> interrupted;
+};
@@ -0,0 +1,29 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TilePos;
+
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+//one byte per tile: type in the low 4 bits, then highlight (16) and wall (32)
+uniform usampler2D tiles;
+uniform ivec2 tileCount;
+
+void main()
+{
+	ivec2 tile = ivec2(floor(TilePos));
+	//the last chunks hang off the edge of the floor
+	if (tile.x >= tileCount.x || tile.y >= tileCount.y)
+		discard;
+	uint attributes = texelFetch(tiles, tile, 0).r;
+
+	//the ground textures repeat once per tile. the tiles make a checkerboard, a type of 1 swaps a tile's shade
+	vec4 colour = mix(texture(texture1, TilePos), texture(texture2, TilePos), 0.2);
+	if (((attributes & 15u) ^ uint((tile.x + tile.y) & 1)) == 1u)
+		colour.rgb *= 0.85;
+	if ((attributes & 32u) != 0u)
+		colour.rgb = mix(colour.rgb, vec3(0.35, 0.2, 0.1), 0.7);
+	if ((attributes & 16u) != 0u)
+		colour.rgb = mix(colour.rgb, vec3(1.0, 0.9, 0.2), 0.4);
+	FragColor = colour;
+}
@@ -0,0 +1,24 @@
+#version 330 core
+//one quad per chunk: aPos is the corner (0..1), aChunk which chunk this instance is
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aChunk;
+
+out vec2 TilePos; //position on the floor counted in tiles
+
+//camera of the view being drawn, one slot of the renderer's view uniform buffer
+layout (std140) uniform ViewData {
+	mat4 view;
+	mat4 projection;
+	vec4 viewPos;
+};
+
+uniform vec2 origin; //world x/z of the floor's first tile corner
+uniform float tileSize;
+uniform float chunkTiles;
+
+void main()
+{
+	TilePos = (aChunk + aPos) * chunkTiles;
+	vec3 worldPos = vec3(origin.x + TilePos.x * tileSize, 0.0, origin.y + TilePos.y * tileSize);
+	gl_Position = projection * view * vec4(worldPos, 1.0);
+}
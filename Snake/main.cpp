@@ -2,6 +2,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,11 +11,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include "Shader.h"
 #include "Setup.h"
 
-#include "Model.h"
 #include "Camera.h"
+#include "FloorGrid.h"
+#include "FollowCamera.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "Renderer.h"
+#include "SceneGraph.h"
+#include "SnakeRandom.h"
+#include "SpatialGrid.h"
+#include "TransformStore.h"
 
 using namespace std;
 
@@ -29,33 +37,41 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 //wheel scroll callback
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
-void processInputs(GLFWwindow* window);
+//window contents lost (uncovered, restored) callback
+void window_refresh_callback(GLFWwindow* window);
+
+//keyboard callback, queues presses for the simulation
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
-unsigned int loadTexture(char const * path);
-
-//Vertex Shader Program Source Code
-const char* vertexShaderSource =
-"#version 330 core\n"
-"layout(location = 0) in vec3 aPos;\n" //variable location[0], read value in of type vec3
-"\n"
-"void main()\n"
-"{\n"
-"    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
-"}\n\0";//need \0 to tell it its the end of the character string
-
-//Fragment Shader Program Source Code
-const char* fragmentShaderSource =
-"#version 330 core\n"
-"out vec4 FragColor;\n" //value passed on to next shader when done
-"\n"
-"void main()\n"
-"{\n"
-"FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
-"}\n\0";
+//mouse button callback, queued like the keys
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+
+void processInputs(GLFWwindow* window);
+void consumeInputEvents(double untilTime);
+void sampleLook();
+void simulateTick(float dt);
+void buildSnapshot(RenderSnapshot &snapshot);
 
 //Camera Details
 Camera camera(glm::vec3(0.0f, 0.0f, 30.0f));
 
+//follow camera, C switches between it and the free camera
+FollowCamera followRig;
+bool followCamera = false;
+void updateFollowFieldOfView();
+
+//split screen, V cycles through one, two and four views. the main camera is always view 0, the others are
+//spectators watching the arena from its far end and its two sides
+const int SPECTATOR_COUNT = 3;
+Camera spectators[SPECTATOR_COUNT] = {
+	Camera(glm::vec3(0.0f, 45.0f, -110.0f), glm::vec3(0.0f, 1.0f, 0.0f), 90.0f, -35.0f),
+	Camera(glm::vec3(-85.0f, 45.0f, -25.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, -35.0f),
+	Camera(glm::vec3(85.0f, 45.0f, -25.0f), glm::vec3(0.0f, 1.0f, 0.0f), 180.0f, -35.0f)
+};
+unsigned int viewCount = 1;
+glm::vec4 viewRect(unsigned int view);
+void applyViewLayout();
+
 bool firstMouse = true;
 float fov = 45.0f;
 
@@ -70,6 +86,53 @@ float lastX = 400, lastY = 300;
 float deltaTime = 0.0f;	// Time between current frame and last frame
 float lastFrame = 0.0f; // Time of last frame
 
+//rendering happens on its own thread, we just hand it snapshots
+Renderer renderer;
+unsigned long long frameNumber = 0;
+unsigned int framesShown = 0; //presented frames already counted in the title
+int framebufferWidth = 1280, framebufferHeight = 720;
+
+//frame pacing
+FramePacer pacer(60.0);
+RenderSettings renderSettings; //vsync and dynamic resolution bounds, handed to the render thread at startup
+const double MENU_IDLE_TIMEOUT = 0.5; //seconds the static menu sleeps waiting for events
+
+//input
+InputQueue inputQueue;
+const double SIM_TICK = 1.0 / 120.0; //fixed simulation step, queued input is consumed at this granularity
+const double MAX_SIM_LAG = 0.25; //after a long stall skip ahead instead of running hundreds of ticks
+double simTime = 0.0; //time the simulation has been advanced to
+double latencyStart = -1.0; //time of the oldest input that hasn't made it to the screen yet
+
+const float SEGMENT_RADIUS = 2.5f;
+
+//arena yoshi is kept inside: a square of tiles one segment across around ARENA_CENTRE, M cycles through the sizes.
+//the floor, the grid below and the walls all follow it
+const int ARENA_SIZES[] = { 16, 256, 2048 };
+const int ARENA_SIZE_COUNT = sizeof(ARENA_SIZES) / sizeof(ARENA_SIZES[0]);
+const float ARENA_CENTRE_X = 0.0f;
+const float ARENA_CENTRE_Z = -25.0f;
+int arenaSize = 0; //index into ARENA_SIZES
+float arenaMinX, arenaMaxX, arenaMinZ, arenaMaxZ;
+void resizeArena(int tiles);
+
+//everything on the arena floor goes in a grid for pickup and collision checks, cells are one segment across
+//so anything touching a segment is always in the 3x3 cells around it. only the blocks of it in use are allocated
+SpatialGrid arenaGrid(0.0f, 0.0f, 1.0f, 1.0f, SEGMENT_RADIUS * 2.0f);
+int yoshiEntity, eggEntity;
+
+//eggs are laid on a random tile inside the walls, never yoshi's. the generator is seeded once at startup, so the
+//same inputs lay the same eggs on any machine
+const uint64_t GAME_SEED = 0x5EED;
+SnakeRandom gameRandom(GAME_SEED);
+void spawnEgg();
+
+//the floor is tiled to the same size, walls round the edge and the tile yoshi stands on lit up
+FloorGrid arenaFloor;
+int highlightX = -1, highlightZ = -1;
+void createFloor();
+void highlightYoshiTile();
+
 //movement of models
 float posX;
 float posZ;
@@ -78,7 +141,23 @@ bool movingDown;
 bool movingLeft;
 bool movingRight;
 float yoshiRotation = glm::radians(-90.0f);
+
+//transforms of everything in the scene, world matrices only get rebuilt for what moved
+TransformStore transforms;
+unsigned int eggTransform, yoshiTransform;
+void createTransforms();
+
+//hierarchy on top: every model's own nodes hang below the scene node that places it
+SceneGraph scene;
+SceneNode eggNode, yoshiNode;
+void createScene();
+
+//mouse picking, the cursor is captured so it always goes through the centre of the screen
+const char* MODEL_NAMES[RENDER_MODEL_COUNT] = { "egg", "yoshi" };
+const char* pickedName = "nothing";
+void pickAtCrosshair();
 void resetMovement();
+void turnYoshi(int key);
 
 void main()
 {
@@ -107,8 +186,11 @@ void main()
 		return;
 	}
 
-	//set up openGL viewport x,y,w,h
-	glViewport(0, 0, 1280, 720);
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	applyViewLayout();
+
+	createTransforms();
+	resizeArena(ARENA_SIZES[arenaSize]);
 
 	//hide cursor but also capture it inside this window
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -118,430 +200,277 @@ void main()
 	//setup mouse move callback
 	glfwSetCursorPosCallback(window, mouse_callback);
 
+	//keyboard presses go through the input queue
+	glfwSetKeyCallback(window, key_callback);
+
 	//scroll wheel callback
 	glfwSetScrollCallback(window, scroll_callback);
 
+	//clicks pick whatever is under the crosshair
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
 
-	//set z depth buffering on
-	glEnable(GL_DEPTH_TEST);
-
-	//load images in, flip them
-	stbi_set_flip_vertically_on_load(true);
-
-	glfwSetFramebufferSizeCallback(window, windowResizeCallBack);
-
-	Shader shaderProgram1("vertexShader1.txt", "fragmentShader1.txt");
-	Shader lightShader("modelShader.vs", "modelShader.fs");
-	Shader lampShader("shader6.vs", "lampShader.fs");
-	Shader groundShader("cubeVertexShader.txt", "cubeFragmentShader.txt");
-
-	Model yoshiEgg("assets/Egg/YoshiEgg.obj");
-	Model yoshi("assets/Yoshi/Yoshi.obj");
-
-	//Compile Shader Source into shader programs
-	//vertex shader first
-	int vertexShaderID = glCreateShader(GL_VERTEX_SHADER);//gives id for a vertex shader
-														  //give it the source code
-														  //params:
-														  //		shader id
-														  //		number of source strings
-														  //		source strings (1 or array)
-														  //		length of string or NULL if it ends in a \0
-	glShaderSource(vertexShaderID, 1, &vertexShaderSource, NULL);
-	//compile the code on the gpu
-	glCompileShader(vertexShaderID);
-
-	//check for errors
-	int success;
-	char infoLog[512];
-
-	//check compile status for our program, store result in success
-	glGetShaderiv(vertexShaderID, GL_COMPILE_STATUS, &success);
-	//failed?
-	if (!success) {
-		//get error for the log and store in infoLog
-		glGetShaderInfoLog(vertexShaderID, 512, NULL, infoLog);
-		cout << "Vertex shader error!: " << infoLog << endl;
-		system("pause");
-	}
-	//Fragment shader
-	int fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShaderID, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShaderID);
-
-	glGetShaderiv(fragmentShaderID, GL_COMPILE_STATUS, &success);
-	//failed?
-	if (!success) {
-		//get error for the log and store in infoLog
-		glGetShaderInfoLog(fragmentShaderID, 512, NULL, infoLog);
-		cout << "Fragment shader error!: " << infoLog << endl;
-		system("pause");
-	}
-	//Create a Shader Program which links a bunch of shaders together for a full pipeline
-	int shaderProgramID = glCreateProgram();
-	//attach our shaders to this program
-	glAttachShader(shaderProgramID, vertexShaderID);
-	glAttachShader(shaderProgramID, fragmentShaderID);
-	//link the attached shaders
-	glLinkProgram(shaderProgramID);
-	//check for linking errors
-	glGetProgramiv(shaderProgramID, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgramID, 512, NULL, infoLog);
-		cout << "Shader Program Linking Error!: " << infoLog << endl;
-		system("pause");
-	}
-	//our shaders were used to help make the full shader program, we dont need them individually anymore
-	glDeleteShader(vertexShaderID);
-	glDeleteShader(fragmentShaderID);
-
-	float textureRectVertices[] = {
-		// positions // colors // texture coords
-		1, 1, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // top right
-		1, -1, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // bottom right
-		-1, -1, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // bottom left
-		-1, 1, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f // top left 
-	};
-
-	unsigned int textureRectIndices[] = {
-		0, 1, 3, //first triangle 
-		1, 2, 3 //seconds triangle
-	};
-
-	float textureCubeVertices[] = {
-		//x		y		z	tenX	tenY
-		-0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, 0.0f,
-		0.5f, 0.5f, -0.5f, 1.0f, 1.0f,
-		0.5f, 0.5f, -0.5f, 1.0f, 1.0f,
-		-0.5f, 0.5f, -0.5f, 0.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
-
-		-0.5f, -0.5f, 0.5f, 0.0f, 0.0f,
-		0.5f, -0.5f, 0.5f, 1.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 1.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 1.0f,
-		-0.5f, 0.5f, 0.5f, 0.0f, 1.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, 0.0f,
-
-		-0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
-		-0.5f, 0.5f, -0.5f, 1.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f, 1.0f, -1.0f,
-		-0.5f, -0.5f, -0.5f, 1.0f, -1.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, -1.0f,
-		-0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
-
-		0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
-		0.5f, 0.5f, -0.5f, 1.0f, 0.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, -1.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, -1.0f,
-		0.5f, -0.5f, 0.5f, 0.0f, -1.0f,
-		0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
-
-		-0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f, 1.0f, 1.0f,
-		0.5f, -0.5f, 0.5f, 1.0f, 0.0f,
-		0.5f, -0.5f, 0.5f, 1.0f, 0.0f,
-		-0.5f, -0.5f, 0.5f, 0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
-
-		-0.5f, 0.5f, -0.5f, 0.0f, 1.0f,
-		0.5f, 0.5f, -0.5f, 1.0f, 1.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 0.0f,
-		0.5f, 0.5f, 0.5f, 1.0f, 0.0f,
-		-0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
-		-0.5f, 0.5f, -0.5f, 0.0f, 1.0f
-	};
-
-	//menu vbo/vao and binding
-	unsigned int textureRectVBO;
-	glGenBuffers(1, &textureRectVBO);
-	
-	unsigned int textureRectEBO;
-	glGenBuffers(1, &textureRectEBO);
-
-	unsigned int textureRectVAO;
-	glGenVertexArrays(1, &textureRectVAO);
-	//to work with this VAO bind it to make it the current one
-	glBindVertexArray(textureRectVAO);
-
-		//bind vbo
-		glBindBuffer(GL_ARRAY_BUFFER, textureRectVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(textureRectVertices), textureRectVertices, GL_STATIC_DRAW);
-
-		//bind ebo
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, textureRectEBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(textureRectIndices), textureRectIndices, GL_STATIC_DRAW);
-
-		//position (x, y, z)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-
-		//colour (r, g, b)
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-
-		//Texture Coordinate(S,T)
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-		glEnableVertexAttribArray(2);
-
-	//unbind VAO
-	glBindVertexArray(0);
-
-	unsigned int texture1ID;
-	glGenTextures(1, &texture1ID);
-	glBindTexture(GL_TEXTURE_2D, texture1ID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//wrap on the s(x) axis
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//wraps on the t(y) axis
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);//GL_LINEAR(bilinear) or GL_NEAREST for shrinking
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);//for stretching
-
-	//load up jpg file
-
-	//menu
-	int width, height, numberChannels;
-	unsigned char* image1Data = stbi_load("menu.jpg", &width, &height, &numberChannels, 0);
-
-	if (image1Data) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,  0, GL_RGB, GL_UNSIGNED_BYTE, image1Data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else cout << "image failed to load" << endl;
-	
-	stbi_image_free(image1Data);
-
-
-
-
-
-	//generate a texture in gpu, return id
-	unsigned int cubeTexture1ID;
-	glGenTextures(1, &cubeTexture1ID);
-	//we bind the texture to make it the one we're working on
-	glBindTexture(GL_TEXTURE_2D, cubeTexture1ID);
-	//set wrapping options(repeat texture if texture coordinates dont fully cover polygons)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//wrap on the s(x) axis
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//wraps on the t(y) axis
-																 //set filtering options
-																 //Suggestion use nearest neighbour for pixel art, use bilinear for pretty much everything else
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);//GL_LINEAR(bilinear) or GL_NEAREST for shrinking
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);//for stretching
-
-																	 //LOAD UP IMAGE FILE (JPEG FIRST)
-	int cubeWidth, cubeHeight, cubeNumberChannels; //as we load an image, we'll get values from it to fill these in
-	unsigned char *ground1Data = stbi_load("assets/yoshiGround/yoshiGround.jpg", &cubeWidth, &cubeHeight, &cubeNumberChannels, 0);
-	//if it loaded
-	if (ground1Data) {
-		cout << "Success! Image is " << cubeWidth << " by " << cubeHeight << "pixels" << endl;
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cubeWidth, cubeHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, ground1Data);
-
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		cout << "Image load failed!" << endl;
-	}
-	//cleanup image memory
-	stbi_image_free(ground1Data);
-
-	//Generate a texture in our graphics card to work with
-	unsigned int cubeTexture2ID;
-	glGenTextures(1, &cubeTexture2ID); //generate 1 texture id and store in texture2ID
-	glBindTexture(GL_TEXTURE_2D, cubeTexture2ID);//make this texture the currently working texture, sayings its a 2d texture (as opposed to 1d and 3d)
-											 //how will texture repeat on large surfaces
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);//how wrap horizontally (S axis...)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);//how to wrap vertically (T axis..)
-																 //how will texture deal with shrink and stretch
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); //when shrinking texture use bilinear filter
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);//use nearest neighbour filtering on stretch
-
-																	  //Load up an image
-	unsigned char *groundData2 = stbi_load("assets/yoshiGround/yoshiGround.png", &cubeWidth, &cubeHeight, &cubeNumberChannels, 0);
-	if (groundData2) {
-		//give the texture in our graphics card the data from this png file
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cubeWidth, cubeHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, groundData2);
-		//generate mipmaps for this texture
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		cout << "failed to load score" << endl;
-	}
-	//free image data from ram because theres a copy in the texture
-	stbi_image_free(groundData2);
-
-	unsigned int cubeVBO;
-	glGenBuffers(1, &cubeVBO);
-
-	//3. Vertex Array Object? tries to describe the data in the VBO and relay it to the first shader
-	unsigned int cubeVAO;
-	glGenVertexArrays(1, &cubeVAO);
-
-	glBindVertexArray(cubeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-
-	glBufferData(GL_ARRAY_BUFFER, sizeof(textureCubeVertices), textureCubeVertices, GL_STATIC_DRAW);
-
-	//xyz to location = 0
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	//texture coordinates to location = 1
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	//unbind stuff
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-
-
+	//redraw the idle menu when the window needs repainting
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
+	//the render thread owns the GL context from here on, it loads all the shaders, models and textures itself
+	glfwMakeContextCurrent(NULL);
+	renderSettings.frameTimeBudget = 1.0 / pacer.GetTargetFPS();
+	renderer.Start(window, renderSettings);
+	createScene();
 
 	glfwSetCursorPos(window, lastX, lastY);
 	//GAME LOOP
 	//camera position and angle
 	camera.setPosition(0, 50.0f, 30.0f);
 	camera.setAngle(-90.0f, -50.0f);
+	followRig.SetViewDirection(camera.Front);
+	updateFollowFieldOfView();
 
 	while (!glfwWindowShouldClose(window)) {
 
+		//idle menu: nothing changes on the menu between frames, so instead of redrawing the same image
+		//we sleep until glfw has an event for us and only redraw when the window asks for it
+		if (menu && !pacer.RedrawRequested()) {
+			glfwWaitEventsTimeout(MENU_IDLE_TIMEOUT);
+			processInputs(window);
+			consumeInputEvents(glfwGetTime());
+			//don't let the time spent asleep show up as one giant deltaTime
+			lastFrame = glfwGetTime();
+			continue;
+		}
+
 		//time management
 		float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
 		//user input
+		glfwPollEvents();
 		processInputs(window);
 
-		glClearColor(0, 0, 1, 1); //blue
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //clear screen with clear colour
-		
-		glm::mat4 view = camera.GetViewMatrix();
-		glm::mat4 projection = glm::mat4(1.0f);
-		projection = glm::perspective(glm::radians(camera.Zoom), 800.0f / 600.0f, 0.1f, 100.0f);
-
+		//run the simulation in fixed ticks, each tick only sees the key presses that happened before it
+		double now = glfwGetTime();
 		if (menu) {
+			consumeInputEvents(now);
+			simTime = now;
+		}
+		if (now - simTime > MAX_SIM_LAG)
+			simTime = now - MAX_SIM_LAG;
+		while (!menu && simTime + SIM_TICK <= now) {
+			simTime += SIM_TICK;
+			consumeInputEvents(simTime);
+			simulateTick((float)SIM_TICK);
+		}
 
-
+		if (menu) {
 			//resetting yoshi and camera
 			camera.setPosition(0, 50.0f, 30.0f);
 			camera.setAngle(-90.0f, -50.0f);
 
 			posX = 0;
 			posZ = 0;
+			arenaGrid.Move(yoshiEntity, posX, posZ);
+			highlightYoshiTile();
 			resetMovement();
 			yoshiRotation = glm::radians(-90.0f);
-			//
-			
-			//menu screen			
-			shaderProgram1.use();
-			int texture1Uniform = glGetUniformLocation(shaderProgram1.ID, "texture1");
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, texture1ID);
-			glUniform1i(texture1Uniform, 0);
-			glBindVertexArray(textureRectVAO);
-
-			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+			followRig.Start(camera.Position);
 		}
 
-		if (!menu) {
-
-			groundShader.use();
-
-			glBindVertexArray(cubeVAO);
-
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, cubeTexture1ID);
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, cubeTexture2ID);
-
-			glUniform1i(glGetUniformLocation(groundShader.ID, "texture1"), 0);
-			glUniform1i(glGetUniformLocation(groundShader.ID, "texture2"), 1);
-
-			glUniformMatrix4fv(glGetUniformLocation(groundShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-			glUniformMatrix4fv(glGetUniformLocation(groundShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-			glm::mat4 ground = glm::mat4(1.0f);
-			ground = glm::translate(ground, glm::vec3(0.0f, -40.0f, -25.0f));
-			ground = glm::scale(ground, glm::vec3(80.0f, 80.0f, 80.0f));
-
-			glUniformMatrix4fv(glGetUniformLocation(groundShader.ID, "model"), 1, GL_FALSE, glm::value_ptr(ground));
-			glDrawArrays(GL_TRIANGLES, 0, 36); //strarting at stride0, draw 36 rows of vertex data
-
-			//model stuff
-			lightShader.use();
-			lightShader.setVec3("objectColor", 1.0f, 0.5f, 1.0f);
-			lightShader.setVec3("lightColor", lightColour);
-			lightShader.setVec3("lightPos", lightPos);
-			lightShader.setVec3("viewPos", camera.Position);
-
-			glUniformMatrix4fv(glGetUniformLocation(lightShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-			glUniformMatrix4fv(glGetUniformLocation(lightShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-			//eggmodel
-			glm::mat4 eggModel = glm::mat4(1.0f);
-			eggModel = glm::translate(eggModel, glm::vec3(4.0f, 0.0f, 0.0f));
-			eggModel = glm::scale(eggModel, glm::vec3(0.03f, 0.03f, 0.03f));
-			lightShader.setMat4("model", eggModel);
-			yoshiEgg.Draw(lightShader);
-			
-			//yoshi model
-			glm::mat4 yoshiModel = glm::mat4(1.0f);
-			yoshiModel = glm::translate(yoshiModel, glm::vec3(posX, 0.0f, posZ));
-			yoshiModel = glm::rotate(yoshiModel, yoshiRotation, glm::vec3(0, 1, 0));
-			yoshiModel = glm::scale(yoshiModel, glm::vec3(10.0f, 10.0f, 10.0f));
-			lightShader.setMat4("model", yoshiModel);
-			yoshi.Draw(lightShader);
-
-			//movement
-			if (movingUp) {
-				posZ -= deltaTime * 30;
-				if (posZ < -65)
-					posZ = -65;
-			}
-			if (movingDown) {
-				posZ += deltaTime * 30;
-				if (posZ > 15)
-					posZ = 15;
-			}
-			if (movingLeft) {
-				posX -= deltaTime * 30;
-				if (posX < -40)
-					posX = -40;
-			}
-			if (movingRight) {
-				posX += deltaTime * 30;
-				if (posX > 40)
-					posX = 40;
-			}
-			//lampShader.use();
-			//lampShader.setVec3("lightColor", lightColour);
-			
+		//sample the camera as late as possible, picking up mouse movement that arrived while we simulated
+		glfwPollEvents();
+		sampleLook();
 
+		//the rig moves in sim ticks, show it where it would be between the last two
+		if (followCamera && !menu) {
+			float alpha = (float)((now - simTime) / SIM_TICK);
+			glm::vec3 eye = followRig.Eye(std::min(std::max(alpha, 0.0f), 1.0f));
+			camera.setPosition(eye.x, eye.y, eye.z);
 		}
 
-		glfwPollEvents();
-		glfwSwapBuffers(window);
-		showFPS(window);
-
-		
+		//hand the frame over to the render thread, it draws while we move on to the next one
+		buildSnapshot(renderer.BeginSnapshot());
+		renderer.PublishSnapshot();
+
+		unsigned int presented = renderer.FramesPresented();
+		stringstream stats;
+		stats << " Meshes: " << renderer.MeshesVisible() << " drawn " << renderer.MeshesCulled() << " culled " << renderer.MeshesOccluded() << " occluded";
+		stats << " Picked: " << pickedName;
+		showFPS(window, renderer.InputLatencyMs(), presented - framesShown, stats.str());
+		framesShown = presented;
+
+		//menu is now on its way to the screen, leave it there until something needs it redrawn
+		if (menu)
+			pacer.ClearRedraw();
+		else
+			pacer.WaitForNextFrame();
 	}
 
-	//optional: de-allocate all resources
-	glDeleteVertexArrays(1, &textureRectVAO);//params: how many, thing with ids(unsigned int, or array of)
-	glDeleteBuffers(1, &textureRectVBO);
-	glDeleteBuffers(1, &textureRectEBO);
-	//glDeleteBuffers(2, VBOs); //example of deleting 2 VBO ids from the VBOs array
+	renderer.Stop();
 	glfwTerminate();
 	//yoshi
 }
 
+//fills in everything the render thread needs for this frame
+void buildSnapshot(RenderSnapshot &snapshot)
+{
+	snapshot.frame = frameNumber++;
+	snapshot.menu = menu;
+	snapshot.width = framebufferWidth;
+	snapshot.height = framebufferHeight;
+
+	//cached in each camera, only rebuilt when it moved, turned, zoomed or its viewport changed shape
+	snapshot.viewCount = viewCount;
+	for (unsigned int v = 0; v < viewCount; v++) {
+		Camera &viewCamera = v == 0 ? camera : spectators[v - 1];
+		RenderView &view = snapshot.views[v];
+		view.cameraVersion = viewCamera.Version();
+		view.view = viewCamera.GetViewMatrix();
+		view.projection = viewCamera.GetProjectionMatrix();
+		view.frustum = viewCamera.GetFrustum();
+		view.viewPos = viewCamera.Position;
+		view.viewport = viewRect(v);
+	}
+
+	snapshot.lightPos = lightPos;
+	snapshot.lightColour = lightColour;
+
+	snapshot.inputTime = latencyStart;
+	latencyStart = -1.0;
+
+	snapshot.draws.clear();
+	snapshot.occluders.clear();
+	if (menu)
+		return;
+
+	//only yoshi moves, the store works out what actually needs recomposing
+	transforms.SetPosition(yoshiTransform, glm::vec3(posX, 0.0f, posZ));
+	transforms.SetRotation(yoshiTransform, glm::angleAxis(yoshiRotation, glm::vec3(0, 1, 0)));
+	transforms.Update();
+
+	//only the chunks that changed since this snapshot was last used get swapped
+	arenaFloor.CopyTo(snapshot.floor);
+
+	//the floor hides anything underneath it
+	Occluder groundOccluder;
+	groundOccluder.transform = glm::mat4(1.0f);
+	groundOccluder.boundsMin = glm::vec3(arenaMinX, -1.0f, arenaMinZ);
+	groundOccluder.boundsMax = glm::vec3(arenaMaxX, 0.0f, arenaMaxZ);
+	snapshot.occluders.push_back(groundOccluder);
+
+	//nodes whose transform didn't change are skipped, so the scene only recomputes yoshi's subtree when he moves
+	scene.SetLocal(eggNode, transforms.World(eggTransform));
+	scene.SetLocal(yoshiNode, transforms.World(yoshiTransform));
+	scene.Update();
+
+	//a draw for every model node with meshes
+	DrawItem item;
+	for (size_t i = 0; i < scene.Size(); i++) {
+		if (scene.RenderModelAt(i) < 0)
+			continue;
+		item.model = (RenderModel)scene.RenderModelAt(i);
+		item.node = scene.ModelNodeAt(i);
+		item.transform = scene.WorldAt(i);
+		snapshot.draws.push_back(item);
+	}
+}
+
+void createTransforms()
+{
+	glm::quat noRotation(1.0f, 0.0f, 0.0f, 0.0f);
+	eggTransform = transforms.Create(glm::vec3(0.0f, 0.0f, 0.0f), noRotation, glm::vec3(0.03f, 0.03f, 0.03f));
+	yoshiTransform = transforms.Create(glm::vec3(posX, 0.0f, posZ), glm::angleAxis(yoshiRotation, glm::vec3(0, 1, 0)), glm::vec3(10.0f, 10.0f, 10.0f));
+}
+
+//new bounds, floor and grid for an arena tiles across, yoshi is pulled back inside if it got smaller
+void resizeArena(int tiles)
+{
+	float halfSize = tiles * SEGMENT_RADIUS;
+	arenaMinX = ARENA_CENTRE_X - halfSize;
+	arenaMaxX = ARENA_CENTRE_X + halfSize;
+	arenaMinZ = ARENA_CENTRE_Z - halfSize;
+	arenaMaxZ = ARENA_CENTRE_Z + halfSize;
+	posX = std::min(std::max(posX, arenaMinX), arenaMaxX);
+	posZ = std::min(std::max(posZ, arenaMinZ), arenaMaxZ);
+
+	arenaGrid.Reset(arenaMinX, arenaMinZ, arenaMaxX, arenaMaxZ, SEGMENT_RADIUS * 2.0f);
+	yoshiEntity = arenaGrid.Insert(posX, posZ);
+	eggEntity = arenaGrid.Insert(ARENA_CENTRE_X, ARENA_CENTRE_Z);
+	createFloor();
+	spawnEgg();
+}
+
+//walls round the edge, the checkerboard comes from the shader so the tiles inside stay 0 and take no memory
+void createFloor()
+{
+	float tileSize = SEGMENT_RADIUS * 2.0f;
+	int tilesX = (int)((arenaMaxX - arenaMinX) / tileSize);
+	int tilesZ = (int)((arenaMaxZ - arenaMinZ) / tileSize);
+	arenaFloor.Resize(tilesX, tilesZ, arenaMinX, arenaMinZ, tileSize);
+	for (int x = 0; x < tilesX; x++) {
+		arenaFloor.Set(x, 0, FLOOR_TILE_WALL);
+		arenaFloor.Set(x, tilesZ - 1, FLOOR_TILE_WALL);
+	}
+	for (int z = 0; z < tilesZ; z++) {
+		arenaFloor.Set(0, z, FLOOR_TILE_WALL);
+		arenaFloor.Set(tilesX - 1, z, FLOOR_TILE_WALL);
+	}
+	highlightX = highlightZ = -1;
+	highlightYoshiTile();
+}
+
+//one draw over the tiles inside the walls less the one yoshi is on (the highlighted one), stepping past his tile
+//when the draw lands on or after it
+void spawnEgg()
+{
+	int innerX = arenaFloor.TilesX() - 2, innerZ = arenaFloor.TilesZ() - 2;
+	int yoshiTile = -1;
+	if (highlightX >= 1 && highlightZ >= 1 && highlightX <= innerX && highlightZ <= innerZ)
+		yoshiTile = (highlightZ - 1) * innerX + highlightX - 1;
+	int tile = (int)gameRandom.Below((uint32_t)(innerX * innerZ - (yoshiTile >= 0 ? 1 : 0)));
+	if (yoshiTile >= 0 && tile >= yoshiTile)
+		tile++;
+
+	float tileSize = SEGMENT_RADIUS * 2.0f;
+	float x = arenaMinX + (tile % innerX + 1.5f) * tileSize;
+	float z = arenaMinZ + (tile / innerX + 1.5f) * tileSize;
+	transforms.SetPosition(eggTransform, glm::vec3(x, 0.0f, z));
+	arenaGrid.Move(eggEntity, x, z);
+}
+
+//moves the highlight along with yoshi, only touches the floor when he crosses into another tile
+void highlightYoshiTile()
+{
+	int x, z;
+	if (!arenaFloor.TileAt(posX, posZ, x, z))
+		x = z = -1;
+	if (x == highlightX && z == highlightZ)
+		return;
+	arenaFloor.ClearFlags(highlightX, highlightZ, FLOOR_TILE_HIGHLIGHT);
+	arenaFloor.SetFlags(x, z, FLOOR_TILE_HIGHLIGHT);
+	highlightX = x;
+	highlightZ = z;
+}
+
+//waits for the render thread to have the models loaded
+void createScene()
+{
+	eggNode = scene.Create(NO_SCENE_NODE, transforms.World(eggTransform));
+	scene.AttachModel(renderer.ModelNodes(RENDER_MODEL_EGG), RENDER_MODEL_EGG, eggNode);
+	yoshiNode = scene.Create(NO_SCENE_NODE, transforms.World(yoshiTransform));
+	scene.AttachModel(renderer.ModelNodes(RENDER_MODEL_YOSHI), RENDER_MODEL_YOSHI, yoshiNode);
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	//the render thread picks the new size up with the next snapshot
+	framebufferWidth = width;
+	framebufferHeight = height;
+	applyViewLayout();
+}
+
+void window_refresh_callback(GLFWwindow* window)
+{
+	pacer.RequestRedraw();
 }
 
 
@@ -558,67 +487,215 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 	lastX = xpos;
 	lastY = ypos;
 
-	camera.ProcessMouseMovement(xoffset, yoffset);
+	//the camera picks this up right before the view matrix is built, see sampleLook
+	inputQueue.AddLook(xoffset, yoffset, glfwGetTime());
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
-	camera.ProcessMouseScroll(yoffset);
+	inputQueue.AddScroll(yoffset);
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (action == GLFW_PRESS)
+		inputQueue.Push(INPUT_MOUSE_PRESS, button, glfwGetTime());
+	else if (action == GLFW_RELEASE)
+		inputQueue.Push(INPUT_MOUSE_RELEASE, button, glfwGetTime());
 }
 
-unsigned int loadTexture(char const * path)
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
+	//key repeats are ignored, holding an arrow shouldn't keep re-turning
+	if (action == GLFW_PRESS)
+		inputQueue.Push(INPUT_KEY_PRESS, key, glfwGetTime());
+	else if (action == GLFW_RELEASE)
+		inputQueue.Push(INPUT_KEY_RELEASE, key, glfwGetTime());
+}
 
-	int width, height, nrComponents;
-	unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-	if (data)
-	{
-		GLenum format;
-		if (nrComponents == 1)
-			format = GL_RED;
-		else if (nrComponents == 3)
-			format = GL_RGB;
-		else if (nrComponents == 4)
-			format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
+//applies the queued key presses that happened up to untilTime, in the order they were pressed.
+//only one turn is taken per call, so quickly tapping UP then LEFT turns on two consecutive ticks
+//instead of the second press silently overwriting the first
+void consumeInputEvents(double untilTime)
+{
+	bool turned = false;
+	while (!inputQueue.Empty()) {
+		const InputEvent &e = inputQueue.Peek();
+		if (e.time > untilTime)
+			break;
+
+		if (e.type == INPUT_KEY_PRESS) {
+			if (menu) {
+				if (e.code == GLFW_KEY_SPACE)
+					menu = false;
+			}
+			else if (e.code == GLFW_KEY_BACKSPACE) {
+				menu = true;
+			}
+			else if (e.code == GLFW_KEY_C) {
+				//the rig looks in one fixed direction and glides over from wherever the camera is now
+				followCamera = !followCamera;
+				if (followCamera) {
+					camera.setAngle(-90.0f, -50.0f);
+					followRig.SetViewDirection(camera.Front);
+					followRig.Start(camera.Position);
+				}
+			}
+			else if (e.code == GLFW_KEY_V) {
+				viewCount = viewCount == 1 ? 2 : viewCount == 2 ? 4 : 1;
+				applyViewLayout();
+			}
+			else if (e.code == GLFW_KEY_M) {
+				arenaSize = (arenaSize + 1) % ARENA_SIZE_COUNT;
+				resizeArena(ARENA_SIZES[arenaSize]);
+			}
+			else if (e.code == GLFW_KEY_UP || e.code == GLFW_KEY_DOWN || e.code == GLFW_KEY_LEFT || e.code == GLFW_KEY_RIGHT) {
+				if (turned)
+					break; //leave it for the next tick
+				turnYoshi(e.code);
+				turned = true;
+				if (latencyStart < 0.0)
+					latencyStart = e.time;
+			}
+		}
+		else if (e.type == INPUT_MOUSE_PRESS) {
+			if (!menu && e.code == GLFW_MOUSE_BUTTON_LEFT)
+				pickAtCrosshair();
+		}
+		inputQueue.Pop();
 	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
+}
+
+//casts a ray from the camera through the centre of the screen against the real triangles of every model in the
+//scene. the ray is taken into each node's local space so the meshes' BVHs can be used as they are
+void pickAtCrosshair()
+{
+	glm::vec3 origin, direction;
+	camera.ScreenRay(0.0f, 0.0f, origin, direction);
+
+	float closest = FAR_PLANE;
+	int picked = -1;
+	for (size_t i = 0; i < scene.Size(); i++) {
+		int model = scene.RenderModelAt(i);
+		if (model < 0)
+			continue;
+		const std::vector<ModelNode> &nodes = renderer.ModelNodes((RenderModel)model);
+		const std::vector<std::shared_ptr<const MeshBVH> > &collision = renderer.ModelCollision((RenderModel)model);
+
+		//not normalised again, so hit distances stay in world units
+		glm::mat4 toLocal = glm::inverse(scene.WorldAt(i));
+		glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+		glm::vec3 localDirection = glm::vec3(toLocal * glm::vec4(direction, 0.0f));
+
+		const std::vector<unsigned int> &meshes = nodes[scene.ModelNodeAt(i)].meshes;
+		for (size_t m = 0; m < meshes.size(); m++) {
+			RayHit hit;
+			if (collision[meshes[m]]->Raycast(localOrigin, localDirection, closest, hit)) {
+				closest = hit.t;
+				picked = model;
+			}
+		}
+	}
+	pickedName = picked >= 0 ? MODEL_NAMES[picked] : "nothing";
+}
+
+//applies all mouse movement since the last frame to the camera in one go
+void sampleLook()
+{
+	float xoffset, yoffset;
+	double time;
+	if (inputQueue.TakeLook(xoffset, yoffset, time) && !followCamera) {
+		camera.ProcessMouseMovement(xoffset, yoffset);
+		if (latencyStart < 0.0 || time < latencyStart)
+			latencyStart = time;
+	}
+	float scroll = inputQueue.TakeScroll();
+	if (scroll != 0.0f) {
+		camera.ProcessMouseScroll(scroll);
+		updateFollowFieldOfView();
+	}
+}
+
+//auto zoom has to know how much the camera can see
+void updateFollowFieldOfView()
+{
+	followRig.SetFieldOfView(glm::radians(camera.Zoom), camera.GetAspect());
+}
+
+//where view v goes in the window, as fractions of its size: full screen, side by side, or quadrants
+glm::vec4 viewRect(unsigned int view)
+{
+	if (viewCount == 1)
+		return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	if (viewCount == 2)
+		return glm::vec4(view * 0.5f, 0.0f, 0.5f, 1.0f);
+	//main view top left, reading order from there
+	return glm::vec4((view % 2) * 0.5f, view < 2 ? 0.5f : 0.0f, 0.5f, 0.5f);
+}
+
+//gives every camera in use the aspect ratio of its own rectangle, after a layout change or a resize
+void applyViewLayout()
+{
+	for (unsigned int v = 0; v < viewCount; v++) {
+		Camera &viewCamera = v == 0 ? camera : spectators[v - 1];
+		glm::vec4 rect = viewRect(v);
+		viewCamera.SetViewportSize((int)(rect.z * framebufferWidth), (int)(rect.w * framebufferHeight));
 	}
+	updateFollowFieldOfView();
+	pacer.RequestRedraw();
+}
 
-	return textureID;
+//advances the game by one fixed step
+void simulateTick(float dt)
+{
+	//movement
+	if (movingUp) {
+		posZ -= dt * 30;
+		if (posZ < arenaMinZ)
+			posZ = arenaMinZ;
+	}
+	if (movingDown) {
+		posZ += dt * 30;
+		if (posZ > arenaMaxZ)
+			posZ = arenaMaxZ;
+	}
+	if (movingLeft) {
+		posX -= dt * 30;
+		if (posX < arenaMinX)
+			posX = arenaMinX;
+	}
+	if (movingRight) {
+		posX += dt * 30;
+		if (posX > arenaMaxX)
+			posX = arenaMaxX;
+	}
+	arenaGrid.Move(yoshiEntity, posX, posZ);
+	highlightYoshiTile();
+
+	//reaching the egg lays the next one
+	bool reachedEgg = false;
+	arenaGrid.ForEachNear(posX, posZ, SEGMENT_RADIUS, [&reachedEgg](int id) { reachedEgg |= id == eggEntity; });
+	if (reachedEgg)
+		spawnEgg();
+
+	if (followCamera) {
+		glm::vec3 heading((float)movingRight - (float)movingLeft, 0.0f, (float)movingDown - (float)movingUp);
+		followRig.Tick(dt, glm::vec3(posX, 0.0f, posZ), heading, SEGMENT_RADIUS);
+	}
 }
 
 void processInputs(GLFWwindow* window) {
 
 
 
+	//space, backspace and the arrow keys are queued presses, see consumeInputEvents
 	if (menu) {
 		//if esc pressed, set window to 'should close'
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(window, true);
-		if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-			menu = false;
 	}
 
-	if (!menu) {
-		if (glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS)
-			menu = true;
-		
+	if (!menu && !followCamera) {
 		float cameraSpeed = 2.5f * deltaTime; // adjust accordingly
 		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
 			camera.ProcessKeyboard(FORWARD, deltaTime * 5);
@@ -628,31 +705,28 @@ void processInputs(GLFWwindow* window) {
 			camera.ProcessKeyboard(LEFT, deltaTime * 5);
 		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 			camera.ProcessKeyboard(RIGHT, deltaTime * 5);
-		
-
-
-		//yoshi movement
-		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-			yoshiRotation = glm::radians(180.0f);
-			resetMovement();
-			movingUp = true;
+	}
+}
 
-		}
-		if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-			yoshiRotation = glm::radians(0.0f);
-			resetMovement();
-			movingDown = true;
-		}
-		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-			yoshiRotation = glm::radians(-90.0f);
-			resetMovement();
-			movingLeft = true;
-		}
-		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-			yoshiRotation = glm::radians(90.0f);
-			resetMovement();
-			movingRight = true;
-		}
+void turnYoshi(int key) {
+	resetMovement();
+	switch (key) {
+	case GLFW_KEY_UP:
+		yoshiRotation = glm::radians(180.0f);
+		movingUp = true;
+		break;
+	case GLFW_KEY_DOWN:
+		yoshiRotation = glm::radians(0.0f);
+		movingDown = true;
+		break;
+	case GLFW_KEY_LEFT:
+		yoshiRotation = glm::radians(-90.0f);
+		movingLeft = true;
+		break;
+	case GLFW_KEY_RIGHT:
+		yoshiRotation = glm::radians(90.0f);
+		movingRight = true;
+		break;
 	}
 }
 
@@ -14,7 +14,12 @@ uniform vec3 objectColor;
 uniform vec3 lightColor;
 uniform vec3 lightPos;
  
-uniform vec3 viewPos;
+//camera of the view being drawn, viewPos.w is unused
+layout (std140) uniform ViewData {
+	mat4 view;
+	mat4 projection;
+	vec4 viewPos;
+};
 
 void main()
 {
@@ -27,7 +32,7 @@ void main()
 	vec3 diffuse = diff * lightColor * vec3(texture(texture_diffuse1, TexCoord));
 	
 	float specularStrength = 1;
-	vec3 viewDir = normalize(viewPos - FragPos);
+	vec3 viewDir = normalize(viewPos.xyz - FragPos);
 	vec3 reflectDir = reflect(-lightDir, norm); 
 	//                                           specular to the power of 32, the higher the number, the more pinpointed and brighter the light is
 	float spec = pow(max(dot(viewDir, reflectDir), 0.0), 64);
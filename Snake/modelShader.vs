@@ -9,8 +9,12 @@ out vec3 Normal;
 out vec3 FragPos; 
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+//camera of the view being drawn, one slot of the renderer's view uniform buffer
+layout (std140) uniform ViewData {
+	mat4 view;
+	mat4 projection;
+	vec4 viewPos;
+};
 
 void main()
 {
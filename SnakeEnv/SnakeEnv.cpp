@@ -0,0 +1,72 @@
+#include "SnakeEnv.h"
+
+#include <new>
+
+#include "SnakeBatch.h"
+
+//the handle is the batch itself
+struct SnakeEnv {
+	SnakeBatch batch;
+	int height;
+
+	SnakeEnv(uint32_t games, int32_t width, int32_t height, uint64_t seed, int32_t threads) : batch(games, width, height, seed, threads), height(height) {}
+};
+
+//the snake starts in the middle with its body below the head
+static bool snakeFits(int32_t width, int32_t height, int32_t length)
+{
+	return width >= 1 && height >= 2 && length >= 1 && height / 2 + length <= height;
+}
+
+SnakeEnv* snake_env_create(uint32_t games, int32_t width, int32_t height, uint64_t seed, int32_t threads)
+{
+	if (games == 0 || !snakeFits(width, height, 4))
+		return NULL;
+	//no exceptions across the C boundary
+	try {
+		return new SnakeEnv(games, width, height, seed, threads);
+	}
+	catch (const std::bad_alloc &) {
+		return NULL;
+	}
+}
+
+void snake_env_destroy(SnakeEnv* env)
+{
+	delete env;
+}
+
+void snake_env_configure(SnakeEnv* env, int32_t start_length, int32_t growth_per_egg, int32_t starve_ticks)
+{
+	if (snakeFits(1, env->height, start_length))
+		env->batch.SetStartLength(start_length);
+	if (growth_per_egg >= 0)
+		env->batch.SetGrowthPerEgg(growth_per_egg);
+	if (starve_ticks > 0)
+		env->batch.SetStarveTicks(starve_ticks);
+}
+
+uint32_t snake_env_games(const SnakeEnv* env)
+{
+	return env->batch.Games();
+}
+
+size_t snake_env_observation_words(const SnakeEnv* env)
+{
+	return env->batch.ObservationWords();
+}
+
+void snake_env_reset(SnakeEnv* env, uint64_t* observations)
+{
+	env->batch.Reset(observations);
+}
+
+void snake_env_step(SnakeEnv* env, const int32_t* actions, uint64_t* observations, float* rewards, uint8_t* dones)
+{
+	env->batch.Step(actions, observations, rewards, dones);
+}
+
+int32_t snake_env_score(const SnakeEnv* env, uint32_t game)
+{
+	return game < env->batch.Games() ? env->batch.Game(game).Score() : 0;
+}
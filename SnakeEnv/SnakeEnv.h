@@ -0,0 +1,50 @@
+#pragma once
+
+/* C interface to SnakeBatch, built as SnakeEnv.dll, so trainers in other languages can step thousands of games
+ * straight into their own arrays (numpy, torch, ...) without any copying on either side.
+ *
+ * Every array holds one entry per game back to back, observations snake_env_observation_words() 64 bit words per
+ * game: four bitplanes (head, body, egg, walls) of width * height bits rounded up to whole words, cell z * width + x
+ * is bit (cell % 64) of word (cell / 64) of a plane. Actions are 0 up (-z), 1 right (+x), 2 down (+z), 3 left (-x).
+ * An env must only be used from the thread that created it. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(SNAKE_ENV_EXPORTS)
+#define SNAKE_ENV_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define SNAKE_ENV_API __declspec(dllimport)
+#else
+#define SNAKE_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SnakeEnv SnakeEnv;
+
+/* threads is how many step the games in total: -1 uses every hardware thread, 0 or 1 only the calling one. returns NULL when the grid can't fit the starting
+ * snake or memory runs out */
+SNAKE_ENV_API SnakeEnv* snake_env_create(uint32_t games, int32_t width, int32_t height, uint64_t seed, int32_t threads);
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+
+/* applied from the next reset: starting length (4), cells grown per egg (1), ticks without an egg before an episode
+ * is called off (width * height * 4) */
+SNAKE_ENV_API void snake_env_configure(SnakeEnv* env, int32_t start_length, int32_t growth_per_egg, int32_t starve_ticks);
+
+SNAKE_ENV_API uint32_t snake_env_games(const SnakeEnv* env);
+SNAKE_ENV_API size_t snake_env_observation_words(const SnakeEnv* env);
+
+SNAKE_ENV_API void snake_env_reset(SnakeEnv* env, uint64_t* observations);
+/* rewards are +1 for an egg, -1 for dying and 0 otherwise. a game that is done has already been reset, its
+ * observation is the first of its next episode */
+SNAKE_ENV_API void snake_env_step(SnakeEnv* env, const int32_t* actions, uint64_t* observations, float* rewards, uint8_t* dones);
+
+/* eggs eaten so far in a game's current episode */
+SNAKE_ENV_API int32_t snake_env_score(const SnakeEnv* env, uint32_t game);
+
+#ifdef __cplusplus
+}
+#endif